@@ -0,0 +1,274 @@
+/**
+ * @file AsyncExecutor_cl.cpp
+ * @brief Asynchronous circuit execution: futures for histograms, CSV export on an I/O thread
+ *
+ * CompiledCircuit::Run() blocks the caller for the whole simulation, and
+ * writing the histogram for plotter.py blocks it again on the disk. A service
+ * that prepares, simulates and exports one circuit after another therefore
+ * runs three serial phases and leaves either the cores or the disk idle.
+ *
+ * AsyncExecutor splits the phases over two lanes:
+ *
+ *     caller            simulation lane              I/O lane
+ *     prepare reg 1 ─►  Execute + Sample reg 1
+ *     prepare reg 2 ─►  Execute + Sample reg 2   ─►  write CSV 1
+ *     prepare reg 3 ─►  ...                      ─►  write CSV 2
+ *
+ * Submit() moves the register and a copy of the compiled circuit into the
+ * queue and returns at once with an AsyncJob: a future for the histogram
+ * and a future reporting whether the CSV was written. Simulation threads
+ * drive the process-wide ThreadPool for each circuit, as a direct Run() would.
+ * One simulation thread (the default) gives every circuit all the cores;
+ * more threads overlap small circuits, which never leave the calling thread.
+ * The single I/O thread formats and writes every CSV, so the simulation
+ * lane never waits on the disk.
+ *
+ * The queue holds at most maxQueued circuits that have not started. Past
+ * that, Submit() blocks, which bounds the memory held by submitted registers.
+ *
+ * Usage:
+ * AsyncExecutor executor;
+ * std::vector<AsyncJob> jobs;
+ * for (const auto &angles : sweep)
+ *     jobs.push_back(executor.Submit(Ansatz(angles).Compile(), Register(20), 10000,
+ *                                    "collapse_measurements.csv"));
+ * for (auto &job : jobs)
+ *     Use(job.counts.get());                       // Rethrows simulation errors
+ * executor.Wait();                                 // Every CSV written
+ *
+ * C++17 has no coroutines, so the handle is a std::future. Destruction
+ * drains both lanes: every submitted job is simulated and exported.
+ *
+ * @author Your Name
+ * @date 2025
+ */
+
+#ifndef ASYNC_EXECUTOR_CL_CPP
+#define ASYNC_EXECUTOR_CL_CPP
+
+#include <cassert>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Circuit_cl.cpp"
+#include "MeasurementSink_cl.cpp"
+
+/// Default bound on circuits waiting to start (each holds its register's state vector)
+constexpr size_t kAsyncMaxQueued = 4;
+
+/**
+ * @struct AsyncJob
+ * @brief Handles of one submitted circuit
+ */
+struct AsyncJob
+{
+    std::future<std::map<uint64_t, size_t>> counts;    ///< Histogram; rethrows simulation errors
+    std::future<bool> written;                         ///< CSV written (true at once when no file was asked for)
+};
+
+/**
+ * @class AsyncExecutor
+ * @brief Simulation worker lane plus an I/O lane for result export
+ *
+ * Submit() and Wait() may be called from any thread.
+ */
+class AsyncExecutor
+{
+public:
+    /**
+     * @brief Start the lanes
+     * @param simulators Simulation threads (circuits run concurrently)
+     * @param maxQueued Most circuits waiting to start before Submit() blocks
+     */
+    explicit AsyncExecutor(unsigned simulators = 1, size_t maxQueued = kAsyncMaxQueued)
+        : maxQueued(maxQueued)
+    {
+        assert(simulators >= 1 && maxQueued >= 1);
+        for (unsigned t = 0; t < simulators; ++t)
+            simulationThreads.emplace_back([this] { Drain(simulation, true); });
+        ioThread = std::thread([this] { Drain(io, false); });
+    }
+
+    AsyncExecutor(const AsyncExecutor &) = delete;
+    AsyncExecutor &operator=(const AsyncExecutor &) = delete;
+
+    /**
+     * @brief Finish every submitted job, then stop the threads
+     */
+    ~AsyncExecutor()
+    {
+        Stop(simulation);
+        for (auto &t : simulationThreads)
+            t.join();
+        Stop(io);                                       // Simulation is done, so no more exports arrive
+        ioThread.join();
+    }
+
+    /**
+     * @brief Queue a circuit for execution on a register, then sampling
+     * @param circuit Compiled program (copied; the caller may reuse or drop it)
+     * @param reg Initial state, moved in (its engine draws the shots)
+     * @param shots Number of samples in the histogram
+     * @param csvFile If non-empty, the histogram is also written there (plotter.py format) on the I/O lane
+     * @return Futures for the histogram and for the CSV write
+     *
+     * Blocks only while maxQueued circuits are already waiting.
+     */
+    template <typename T>
+    AsyncJob Submit(CompiledCircuit circuit, BasicRegister<T> reg, size_t shots, std::string csvFile = "")
+    {
+        auto counts = std::make_shared<std::promise<std::map<uint64_t, size_t>>>();
+        auto written = std::make_shared<std::promise<bool>>();
+        AsyncJob job{counts->get_future(), written->get_future()};
+        if (csvFile.empty())
+            written->set_value(true);
+
+        auto program = std::make_shared<CompiledCircuit>(std::move(circuit));
+        auto state = std::make_shared<BasicRegister<T>>(std::move(reg));
+        std::function<void()> task = [this, program, state, shots, file = std::move(csvFile), counts, written]() mutable {
+            std::map<uint64_t, size_t> histogram;
+            try
+            {
+                histogram = program->Run(*state, shots);
+            }
+            catch (...)
+            {
+                counts->set_exception(std::current_exception());
+                if (!file.empty())
+                    written->set_value(false);
+                Finished();
+                return;
+            }
+            const int bits = state->bits;
+            state.reset();                              // Release the state vector before the export
+            if (file.empty())
+            {
+                counts->set_value(std::move(histogram));
+                Finished();
+                return;
+            }
+            auto exported = std::make_shared<const std::map<uint64_t, size_t>>(histogram);
+            counts->set_value(std::move(histogram));
+            Push(io, [this, exported, bits, file = std::move(file), written] {
+                written->set_value(WriteHistogramCSV(*exported, bits, file));
+                Finished();
+            });
+        };
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            // Check and push under one lock, so concurrent submitters cannot overshoot maxQueued
+            space.wait(lock, [this] { return simulation.tasks.size() < maxQueued; });
+            simulation.tasks.push_back(std::move(task));
+            ++outstanding;
+        }
+        simulation.ready.notify_one();
+        return job;
+    }
+
+    /**
+     * @brief Block until every job submitted so far is simulated and exported
+     */
+    void Wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this] { return outstanding == 0; });
+    }
+
+    /**
+     * @brief Jobs submitted and not yet finished (simulation and export)
+     */
+    size_t Pending() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return outstanding;
+    }
+
+private:
+    /**
+     * @struct Lane
+     * @brief Task queue served by one or more threads
+     */
+    struct Lane
+    {
+        std::deque<std::function<void()>> tasks;
+        std::condition_variable ready;                  ///< Signals a new task or shutdown
+        bool stopping = false;
+    };
+
+    mutable std::mutex mutex;                           ///< Guards both lanes and outstanding
+    std::condition_variable space;                      ///< Signals room in the simulation queue
+    std::condition_variable idle;                       ///< Signals outstanding == 0
+    Lane simulation;
+    Lane io;
+    size_t maxQueued;
+    size_t outstanding = 0;                             ///< Submitted jobs not yet finished
+    std::vector<std::thread> simulationThreads;
+    std::thread ioThread;
+
+    void Push(Lane &lane, std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            lane.tasks.push_back(std::move(task));
+        }
+        lane.ready.notify_one();
+    }
+
+    void Stop(Lane &lane)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            lane.stopping = true;
+        }
+        lane.ready.notify_all();
+    }
+
+    /**
+     * @brief Thread body: run the lane's tasks until it is stopped and empty
+     */
+    void Drain(Lane &lane, bool freesSpace)
+    {
+        for (;;)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                lane.ready.wait(lock, [&lane] { return lane.stopping || !lane.tasks.empty(); });
+                if (lane.tasks.empty())
+                    return;
+                task = std::move(lane.tasks.front());
+                lane.tasks.pop_front();
+            }
+            if (freesSpace)
+                space.notify_one();
+            task();
+        }
+    }
+
+    /**
+     * @brief Mark one job complete (called once per job, from the lane that finishes it)
+     */
+    void Finished()
+    {
+        bool nowIdle;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            nowIdle = --outstanding == 0;
+        }
+        if (nowIdle)
+            idle.notify_all();
+    }
+};
+
+#endif // ASYNC_EXECUTOR_CL_CPP
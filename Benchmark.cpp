@@ -0,0 +1,312 @@
+/**
+ * @file Benchmark.cpp
+ * @brief Performance suite for register gates, measurement and algorithms
+ *
+ * Every kernel change (threading, SIMD, fusion, precision) should be judged
+ * against numbers, not intuition. This executable times the hot paths across
+ * register sizes and reports throughput in the two units that matter for a
+ * state-vector simulator:
+ * - Amplitudes/s: how many state entries a benchmark processes per second
+ * - GB/s: the memory traffic that implies (state-vector sweeps are
+ *   bandwidth-bound, so this is compared against the machine's peak)
+ *
+ * Benchmarks:
+ * - HadamardR / XGateR ApplyToSingle on a low, middle and high qubit
+ *   (stride 1, 2^(n/2) and 2^(n-1) stress different access patterns)
+ * - Collapse / MeasureWithoutCollapse / MeasureIndex shots per second (cached block table;
+ *   MeasureIndex/cold rebuilds it every shot)
+ * - Sample: batched shots per second (one CDF for all shots, rebuilt every run)
+ * - FindInnerProduct
+ * - Deutsch: the full H, oracle, H, measure sequence of Deutsch's algorithm
+ *   with x and y on qubits 1 and 0 of a wider register
+ * - Circuit: a 4-layer brickwork circuit (H·T on every qubit, CNOT/CZ
+ *   bricks) compiled plainly and cache-blocked; amplitudes/s counts one
+ *   amplitude per recorded gate, GB/s is not reported (0)
+ *
+ * Each benchmark repeats until it has run for at least --min-time seconds
+ * (and at least once), in the style of Google Benchmark, and reports the
+ * mean time per iteration. Sizes whose state does not fit the memory budget
+ * are skipped.
+ *
+ * Build & Run:
+ * g++ -std=c++17 -O2 -march=native -pthread Benchmark.cpp -o benchmark.exe
+ * ./benchmark.exe --min-qubits 10 --max-qubits 30 --step 5 --csv baseline.csv
+ *
+ * Options:
+ * --min-qubits N / --max-qubits N / --step N   Register sizes (default 10..30 step 5)
+ * --precision double|float|both                Amplitude type (default double)
+ * --threads N                                  Thread pool size (default: all cores)
+ * --min-time S                                 Seconds per benchmark (default 0.2)
+ * --filter TEXT                                Only run benchmarks whose name contains TEXT
+ * --csv FILE                                   Also write results as CSV for baseline diffs
+ *
+ * @author Your Name
+ * @date 2025
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "DeutscheAlgo_example.cpp"
+#include "Circuit_cl.cpp"
+
+/**
+ * @struct BenchmarkResult
+ * @brief One row of the report
+ */
+struct BenchmarkResult{
+    std::string name;               ///< e.g. "HadamardR/q0/n20/double"
+    uint64_t iterations;            ///< Timed repetitions
+    double secondsPerIteration;     ///< Mean wall time per repetition
+    double amplitudesPerSecond;     ///< Amplitudes processed per second
+    double bytesPerSecond;          ///< Implied memory traffic per second
+    double itemsPerSecond;          ///< Shots/s for measurement benchmarks (0 otherwise)
+};
+
+/**
+ * @struct BenchmarkOptions
+ * @brief Command-line configuration
+ */
+struct BenchmarkOptions{
+    int minQubits = 10;
+    int maxQubits = 30;
+    int step = 5;
+    bool runDouble = true;
+    bool runFloat = false;
+    unsigned threads = 0;           ///< 0 → hardware concurrency
+    double minTime = 0.2;
+    std::string filter;
+    std::string csvPath;
+};
+
+/**
+ * @class BenchmarkRunner
+ * @brief Times callables and collects BenchmarkResult rows
+ */
+class BenchmarkRunner{
+public:
+    explicit BenchmarkRunner(const BenchmarkOptions& opts) : options(opts) {}
+
+    /**
+     * @brief Time one benchmark
+     * @param name Row name
+     * @param amplitudes Amplitudes processed per iteration
+     * @param bytes Bytes read + written per iteration
+     * @param items Items (shots) produced per iteration, 0 if not applicable
+     * @param body The work of one iteration
+     *
+     * One untimed warm-up iteration first touches the pages and wakes the
+     * thread pool; then iterations run until minTime has elapsed.
+     */
+    void Run(const std::string& name, double amplitudes, double bytes, double items, const std::function<void()>& body){
+        if(!options.filter.empty() && name.find(options.filter) == std::string::npos) return;
+
+        using Clock = std::chrono::steady_clock;
+        body();                                             // Warm-up
+        uint64_t iterations = 0;
+        double elapsed = 0.0;
+        Clock::time_point start = Clock::now();
+        do{
+            body();
+            ++iterations;
+            elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        } while(elapsed < options.minTime);
+
+        double perIteration = elapsed / static_cast<double>(iterations);
+        BenchmarkResult row{name, iterations, perIteration, amplitudes / perIteration, bytes / perIteration,
+                            items > 0 ? items / perIteration : 0.0};
+        Print(row);
+        results.push_back(row);
+    }
+
+    /**
+     * @brief Print the column header
+     */
+    static void PrintHeader(){
+        std::printf("%-42s %14s %12s %14s %10s %14s\n", "Benchmark", "Time/iter", "Iterations", "Amplitudes/s", "GB/s", "Items/s");
+        std::printf("%s\n", std::string(111, '-').c_str());
+    }
+
+    /**
+     * @brief Write every collected row as CSV
+     * @return true if the file was written successfully
+     */
+    bool WriteCSV(const std::string& path) const{
+        std::ofstream file(path);
+        if(!file) return false;
+        file << "Benchmark,Iterations,SecondsPerIteration,AmplitudesPerSecond,GBPerSecond,ItemsPerSecond\n";
+        for(const BenchmarkResult& r : results){
+            file << r.name << "," << r.iterations << "," << r.secondsPerIteration << "," << r.amplitudesPerSecond
+                 << "," << r.bytesPerSecond / 1e9 << "," << r.itemsPerSecond << "\n";
+        }
+        return static_cast<bool>(file);
+    }
+
+private:
+    BenchmarkOptions options;
+    std::vector<BenchmarkResult> results;
+
+    static std::string FormatTime(double seconds){
+        char buffer[32];
+        if(seconds >= 1.0)       std::snprintf(buffer, sizeof(buffer), "%.3f s", seconds);
+        else if(seconds >= 1e-3) std::snprintf(buffer, sizeof(buffer), "%.3f ms", seconds * 1e3);
+        else                     std::snprintf(buffer, sizeof(buffer), "%.3f us", seconds * 1e6);
+        return buffer;
+    }
+
+    static void Print(const BenchmarkResult& r){
+        std::printf("%-42s %14s %12llu %14.4g %10.3f %14.4g\n", r.name.c_str(), FormatTime(r.secondsPerIteration).c_str(),
+                    static_cast<unsigned long long>(r.iterations), r.amplitudesPerSecond, r.bytesPerSecond / 1e9, r.itemsPerSecond);
+    }
+};
+
+/**
+ * @brief Run every benchmark for one register size and precision
+ * @tparam T Amplitude scalar type
+ * @param runner Collects the results
+ * @param n Number of qubits
+ * @param precision Name suffix ("double" / "float")
+ */
+template <typename T>
+void RunSuite(BenchmarkRunner& runner, int n, const std::string& precision){
+    using Reg = BasicRegister<T>;
+    const double size = static_cast<double>(uint64_t(1) << n);
+    const double ampBytes = sizeof(typename Reg::Amplitude);
+    const std::string suffix = "/n" + std::to_string(n) + "/" + precision;
+
+    Reg reg(n);
+    HadamardR().Apply(reg);                                 // Dense state: no all-zero shortcuts
+    reg.Seed(2025);
+
+    // Single-qubit gate sweeps: every amplitude read and written once
+    const int targets[3] = {0, n / 2, n - 1};
+    const char* labels[3] = {"low", "mid", "high"};
+    for(int t = 0; t < 3; ++t){
+        const int q = targets[t];
+        std::string tag = "/q" + std::to_string(q) + "(" + labels[t] + ")";
+        runner.Run("HadamardR" + tag + suffix, size, 2 * size * ampBytes, 0,
+                   [&]{ HadamardR().ApplyToSingle(reg, q); });
+        runner.Run("XGateR" + tag + suffix, size, 2 * size * ampBytes, 0,
+                   [&]{ XGateR().ApplyToSingle(reg, q); });
+    }
+
+    // Inner product: both states read once
+    Reg other = reg;
+    runner.Run("FindInnerProduct" + suffix, size, 2 * size * ampBytes, 0,
+               [&]{ volatile double sink = std::abs(reg.FindInnerProduct(other)); (void)sink; });
+
+    // Measurement on an unchanged state: the block table is cached, so one block scan per shot
+    const uint64_t blockBytes = std::min<uint64_t>(size, kReduceBlock) * ampBytes;
+    runner.Run("MeasureWithoutCollapse" + suffix, size, blockBytes, 1,
+               [&]{ volatile size_t sink = reg.MeasureWithoutCollapse().size(); (void)sink; });
+    runner.Run("MeasureIndex" + suffix, size, blockBytes, 1,
+               [&]{ volatile uint64_t sink = reg.MeasureIndex(); (void)sink; });
+    // After a state change: the block-sum pass plus the block scan
+    runner.Run("MeasureIndex/cold" + suffix, size, size * ampBytes + blockBytes, 1,
+               [&]{ reg.MarkDirty(true); volatile uint64_t sink = reg.MeasureIndex(); (void)sink; });
+    const size_t shots = 100000;
+    runner.Run("Sample/shots" + std::to_string(shots) + suffix, size, size * (ampBytes + 8), static_cast<double>(shots),
+               [&]{ reg.MarkDirty(true); volatile size_t sink = reg.Sample(shots).size(); (void)sink; });
+    Reg collapsing = reg;
+    runner.Run("Collapse" + suffix, size, size * ampBytes * 5 / 2, 1,
+               [&]{ volatile size_t sink = collapsing.Collapse().size(); (void)sink; });
+
+    // Deutsch: x = qubit 1, y = qubit 0 prepared in |1⟩; 3 H + oracle + H + one measurement
+    DeutschOracle oracle(OracleType::Identity);
+    Reg deutsch(n);
+    runner.Run("Deutsch/balanced" + suffix, size, size * (10 * ampBytes + 8), 0, [&]{
+        std::fill(deutsch.val.begin(), deutsch.val.end(), typename Reg::Amplitude(0, 0));
+        deutsch.val[1] = typename Reg::Amplitude(1, 0);   // |0...01⟩
+        deutsch.MarkDirty();
+        HadamardR H;
+        H.ApplyToSingle(deutsch, 1);
+        H.ApplyToSingle(deutsch, 0);
+        oracle.Apply(deutsch);
+        H.ApplyToSingle(deutsch, 1);
+        volatile size_t sink = deutsch.MeasureWithoutCollapse().size();
+        (void)sink;
+    });
+
+    // Compiled circuits: same brickwork, plain stream vs cache-blocked tiles
+    Circuit brickwork(n);
+    for(int layer = 0; layer < 4; ++layer){
+        for(int q = 0; q < n; ++q) brickwork.H(q).T(q);
+        for(int q = layer % 2; q + 1 < n; q += 2) brickwork.CNOT(q, q + 1);
+        for(int q = (layer + 1) % 2; q + 1 < n; q += 2) brickwork.CZ(q, q + 1);
+    }
+    const double gateAmplitudes = size * static_cast<double>(brickwork.Size());
+    const CompiledCircuit plain = brickwork.Compile();
+    const CompiledCircuit blocked = brickwork.Compile(2, kCacheLocalQubits);
+    runner.Run("Circuit/brickwork/plain" + suffix, gateAmplitudes, 0, 0, [&]{ plain.Execute(deutsch); });
+    runner.Run("Circuit/brickwork/blocked" + suffix, gateAmplitudes, 0, 0, [&]{ blocked.Execute(deutsch); });
+}
+
+/**
+ * @brief Parse command-line options (unknown flags print usage and exit)
+ */
+BenchmarkOptions ParseOptions(int argc, char** argv){
+    BenchmarkOptions opts;
+    for(int i = 1; i < argc; ++i){
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if(i + 1 >= argc){
+                std::cerr << "Missing value for " << arg << std::endl;
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+        if(arg == "--min-qubits")      opts.minQubits = std::stoi(next());
+        else if(arg == "--max-qubits") opts.maxQubits = std::stoi(next());
+        else if(arg == "--step")       opts.step = std::max(1, std::stoi(next()));
+        else if(arg == "--threads")    opts.threads = static_cast<unsigned>(std::stoul(next()));
+        else if(arg == "--min-time")   opts.minTime = std::stod(next());
+        else if(arg == "--filter")     opts.filter = next();
+        else if(arg == "--csv")        opts.csvPath = next();
+        else if(arg == "--precision"){
+            std::string p = next();
+            opts.runDouble = (p == "double" || p == "both");
+            opts.runFloat = (p == "float" || p == "both");
+        }
+        else{
+            std::cerr << "Usage: " << argv[0] << " [--min-qubits N] [--max-qubits N] [--step N]"
+                      << " [--precision double|float|both] [--threads N] [--min-time S]"
+                      << " [--filter TEXT] [--csv FILE]" << std::endl;
+            std::exit(arg == "--help" ? 0 : 1);
+        }
+    }
+    return opts;
+}
+
+int main(int argc, char** argv){
+    BenchmarkOptions opts = ParseOptions(argc, argv);
+    if(opts.threads != 0) ThreadPool::Instance().SetThreadCount(opts.threads);
+
+    std::printf("Bhramanantdarshana benchmarks: %u thread(s), SIMD backend %s, memory budget %.2f GB\n\n",
+                ThreadPool::Instance().ThreadCount(), Simd::kName, Register::MemoryBudget() / 1e9);
+    BenchmarkRunner runner(opts);
+    BenchmarkRunner::PrintHeader();
+
+    for(int n = opts.minQubits; n <= opts.maxQubits; n += opts.step){
+        // Working set: the register, two copies, the Deutsch register and the CDF
+        if(opts.runDouble){
+            if(Register::FitsMemoryBudget(n, 4 * sizeof(COMPLEX<double>) + 8)) RunSuite<double>(runner, n, "double");
+            else std::printf("n%d/double skipped: exceeds memory budget\n", n);
+        }
+        if(opts.runFloat){
+            if(Register::FitsMemoryBudget(n, 4 * sizeof(COMPLEX<float>) + 8)) RunSuite<float>(runner, n, "float");
+            else std::printf("n%d/float skipped: exceeds memory budget\n", n);
+        }
+    }
+
+    if(!opts.csvPath.empty() && !runner.WriteCSV(opts.csvPath)){
+        std::cerr << "Could not write " << opts.csvPath << std::endl;
+        return 1;
+    }
+    return 0;
+}
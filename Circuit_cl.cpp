@@ -0,0 +1,524 @@
+/**
+ * @file Circuit_cl.cpp
+ * @brief Deferred-execution quantum circuits compiled to a flat instruction stream
+ *
+ * Until now a circuit was just code: a sequence of gate.ApplyToSingle(reg, q)
+ * calls through virtual RGates dispatch (see RunDeutschAlgorithm). Circuit
+ * instead records the operations, and Compile() lowers them once into a
+ * CompiledCircuit — a flat array of plain instructions
+ *
+ *     { opcode, target, qubit mask, matrix slot }
+ *
+ * executed by a single switch loop. Compilation is also where optimisation
+ * passes live; currently:
+ * - Gate fusion (GateFuser): runs of single-qubit gates between multi-qubit
+ *   gates are multiplied per qubit and grouped into 1–3 qubit tensor blocks
+ * - Kernel selection: fused matrices equal to H, X or Y use their dedicated
+ *   kernels, diagonal ones the phase-only path
+ * - Cache blocking (optional, CacheBlocked()): consecutive gates on the low
+ *   "local" qubits are grouped into tiles executed slice by slice on
+ *   L2-sized blocks of the state; gates on high qubits first swap their
+ *   qubit into a local position through a logical → physical qubit map
+ *
+ * The compiled form is reusable: run it on a fresh register per experiment,
+ * or execute once and draw thousands of shots with Run().
+ *
+ * Example (Bell state):
+ * Circuit bell(2);
+ * bell.H(1).CNOT(1, 0);
+ * CompiledCircuit program = bell.Compile();
+ * Register reg(2);
+ * auto counts = program.Run(reg, 1000);   // ~500 × |00⟩, ~500 × |11⟩
+ *
+ * @author Your Name
+ * @date 2025
+ */
+
+#ifndef CIRCUIT_CL_CPP
+#define CIRCUIT_CL_CPP
+
+#include <algorithm>
+#include <bitset>
+#include <cassert>
+#include <map>
+#include <numeric>
+#include <vector>
+
+#include "GateFusion_cl.cpp"
+
+/**
+ * @enum Opcode
+ * @brief Kernel selected for a compiled instruction
+ */
+enum class Opcode{
+    Hadamard,       ///< H on target
+    PauliX,         ///< X on target (amplitude swap)
+    PauliY,         ///< Y on target
+    Matrix,         ///< General or diagonal 2×2 on target
+    TensorBlock,    ///< Fused U_{K-1} ⊗ ... ⊗ U_0 on the qubits in mask (K = 2 or 3)
+    Controlled,     ///< 2×2 on target when every qubit in mask is |1⟩
+    Swap,           ///< Exchange qubit positions target and log2(mask) (cache-blocking remap)
+    Tile            ///< Run the next `matrix` instructions slice by slice on 2^target-amplitude blocks
+};
+
+/**
+ * @brief Opcode label used by the profiler (Profile_cl.cpp)
+ */
+inline const char* OpcodeName(Opcode op){
+    switch(op){
+        case Opcode::Hadamard:    return "H";
+        case Opcode::PauliX:      return "X";
+        case Opcode::PauliY:      return "Y";
+        case Opcode::Matrix:      return "Matrix";
+        case Opcode::TensorBlock: return "TensorBlock";
+        case Opcode::Controlled:  return "Controlled";
+        case Opcode::Swap:        return "Swap";
+        case Opcode::Tile:        return "Tile";
+    }
+    return "?";
+}
+
+/**
+ * @struct Instruction
+ * @brief One entry of the compiled instruction stream
+ *
+ * The matrix is referenced by slot index into CompiledCircuit::matrices
+ * rather than by raw pointer, so compiled circuits stay valid when copied.
+ */
+struct Instruction{
+    Opcode op;              ///< Kernel to run
+    int target;             ///< Target qubit (unused for TensorBlock)
+    uint64_t mask;          ///< Control qubits (Controlled) or block qubits (TensorBlock)
+    uint32_t matrix;        ///< First matrix slot; TensorBlock uses K consecutive slots; Tile: instruction count
+};
+
+/**
+ * @class CompiledCircuit
+ * @brief Flat, devirtualised instruction stream produced by Circuit::Compile()
+ */
+class CompiledCircuit{
+public:
+    int bits = 0;                           ///< Register width the circuit was built for
+    std::vector<Instruction> code;          ///< Instructions in execution order
+    std::vector<Matrix2> matrices;          ///< Matrix pool referenced by instructions
+
+    /**
+     * @brief Execute every instruction on the register
+     * @param reg Register (either precision) with at least `bits` qubits
+     *
+     * Tight loop over the instruction array: one switch per instruction,
+     * no virtual calls, no allocation.
+     */
+    template <typename T>
+    void Execute(BasicRegister<T>& reg) const{
+        assert(reg.bits >= bits && "Register too small for circuit");
+        COMPLEX<T>* amp = reg.val.data();
+        const uint64_t size = reg.val.size();
+        for(size_t pc = 0; pc < code.size(); ++pc){
+            const Instruction& in = code[pc];
+            PROFILE_SCOPE(OpcodeName(in.op), in.op == Opcode::TensorBlock ? -1 : in.target, size,
+                          2 * size * sizeof(COMPLEX<T>));  // Tiles: qubit = slice width, one sweep for the body
+            if(in.op == Opcode::Tile){
+                ExecuteTile(amp, size, in.target, pc + 1, in.matrix);
+                pc += in.matrix;                    // Tile body already executed
+                continue;
+            }
+            ExecuteOne(amp, size, in);
+        }
+        reg.MarkDirty(true);
+    }
+
+    /**
+     * @brief Execute on the register, then draw measurement shots
+     * @param reg Register to evolve (left in the final state)
+     * @param shots Number of samples
+     * @return Histogram basis index → count (see Register::Sample)
+     */
+    template <typename T>
+    std::map<uint64_t, size_t> Run(BasicRegister<T>& reg, size_t shots) const{
+        Execute(reg);
+        return reg.Sample(shots);
+    }
+
+    /**
+     * @brief Number of state-vector sweeps the stream performs
+     */
+    size_t Size() const{
+        return code.size();
+    }
+
+    /**
+     * @brief Cache-blocked version of this instruction stream
+     * @param localQubits Qubits per block: slices of 2^localQubits amplitudes should fit L2
+     * @return Equivalent stream made of tiles and qubit swaps
+     *
+     * A gate on qubit q pairs amplitudes 2^q apart; for high q every pair is a
+     * cache (and TLB) miss, and each gate is a full trip to memory. This pass
+     * keeps a logical → physical qubit map and rewrites the stream so that
+     * every gate acts on physical qubits below localQubits:
+     * 1. A gate whose target (or tensor-block qubit) sits at a high position
+     *    first swaps it with a local position, provided the qubit is used
+     *    again soon (kMinUsesToSwap uses within the next localQubits
+     *    instructions); otherwise the gate runs in place as one full sweep,
+     *    which the run-based kernels stream efficiently. The evicted logical
+     *    qubit is the one whose next use is furthest away (ties: the highest
+     *    local position, which keeps the swap's contiguous runs long).
+     * 2. Runs of local gates between swaps become one Tile: the executor
+     *    applies the whole run to one 2^localQubits slice while it is cache
+     *    resident, then moves to the next slice (slices in parallel).
+     *    Controls may stay high: inside a slice they are constant, so the
+     *    gate is either skipped or applied with the local controls only.
+     * 3. At the end, swaps restore the identity map so the register leaves in
+     *    the usual qubit order.
+     *
+     * A tile of k gates costs one memory sweep instead of k, and a swap costs
+     * one (half-state) sweep, so it pays off when several gates touch the low
+     * qubits between visits to high ones. Streams for registers that already
+     * fit in one block are returned unchanged.
+     *
+     * @complexity Time: O(ops · localQubits + swaps · ops), independent of register size
+     */
+    CompiledCircuit CacheBlocked(int localQubits = kCacheLocalQubits) const{
+        assert(localQubits >= 3 && localQubits < 64 && "A block must hold at least a 3-qubit tensor block");
+        if(bits <= localQubits) return *this;
+
+        CompiledCircuit out;
+        out.bits = bits;
+        out.matrices = matrices;
+
+        std::vector<uint64_t> needs(code.size());        // Logical qubits each instruction needs local
+        for(size_t pc = 0; pc < code.size(); ++pc){
+            const Instruction& in = code[pc];
+            assert(in.op != Opcode::Tile && in.op != Opcode::Swap && "Stream is already cache blocked");
+            needs[pc] = in.op == Opcode::TensorBlock ? in.mask : uint64_t(1) << in.target;
+        }
+
+        std::vector<int> position(bits), logical(bits);  // logical → position, position → logical
+        std::iota(position.begin(), position.end(), 0);
+        std::iota(logical.begin(), logical.end(), 0);
+        std::vector<Instruction> tile;
+
+        auto flush = [&]{
+            if(tile.size() >= 2) out.code.push_back({Opcode::Tile, localQubits, 0, static_cast<uint32_t>(tile.size())});
+            out.code.insert(out.code.end(), tile.begin(), tile.end());
+            tile.clear();
+        };
+        auto swapPositions = [&](int a, int b){
+            flush();
+            out.code.push_back({Opcode::Swap, a, uint64_t(1) << b, 0});
+            std::swap(logical[a], logical[b]);
+            position[logical[a]] = a;
+            position[logical[b]] = b;
+        };
+        auto physicalMask = [&](uint64_t logicalMask){
+            uint64_t m = 0;
+            for(int q = 0; q < bits; ++q){
+                if((logicalMask >> q) & 1) m |= uint64_t(1) << position[q];
+            }
+            return m;
+        };
+
+        for(size_t pc = 0; pc < code.size(); ++pc){
+            bool inPlace = false;
+            for(int q = 0; q < bits; ++q){
+                if(!((needs[pc] >> q) & 1) || position[q] < localQubits) continue;
+                if(UsesAhead(needs, pc, q, localQubits) < kMinUsesToSwap){
+                    inPlace = true;                      // Rarely used: one full sweep beats swap in + out
+                    continue;
+                }
+                swapPositions(position[q], ChooseVictim(needs, pc, logical, localQubits));
+            }
+
+            Instruction in = code[pc];
+            if(in.op == Opcode::TensorBlock){
+                // Factors must follow ascending physical order
+                std::vector<std::pair<int, uint32_t>> factors;
+                uint32_t slot = in.matrix;
+                for(int q = 0; q < bits; ++q){
+                    if((in.mask >> q) & 1) factors.emplace_back(position[q], slot++);
+                }
+                std::sort(factors.begin(), factors.end());
+                in.matrix = static_cast<uint32_t>(out.matrices.size());
+                for(const auto& f : factors) out.matrices.push_back(matrices[f.second]);
+                in.mask = physicalMask(in.mask);
+                in.target = factors[0].first;
+            }
+            else{
+                in.target = position[in.target];
+                in.mask = physicalMask(in.mask);
+            }
+            if(inPlace){
+                flush();
+                out.code.push_back(in);                  // Full-state sweep at the current positions
+            }
+            else{
+                tile.push_back(in);
+            }
+        }
+        flush();
+
+        for(int p = 0; p < bits; ++p){
+            if(logical[p] != p) swapPositions(p, position[p]);  // Bring logical qubit p home
+        }
+        return out;
+    }
+
+private:
+    /// A high qubit is swapped into the block only if this many of the next instructions use it
+    static constexpr int kMinUsesToSwap = 3;
+
+    /**
+     * @brief Number of instructions in [pc, pc + window) needing logical qubit q local
+     */
+    static int UsesAhead(const std::vector<uint64_t>& needs, size_t pc, int q, int window){
+        int uses = 0;
+        for(size_t k = pc; k < needs.size() && k < pc + window; ++k){
+            uses += (needs[k] >> q) & 1;
+        }
+        return uses;
+    }
+
+    /**
+     * @brief Run one instruction on an amplitude span (whole state or one tile slice)
+     */
+    template <typename T>
+    void ExecuteOne(COMPLEX<T>* amp, uint64_t size, const Instruction& in) const{
+        const Matrix2* m = matrices.data() + in.matrix;
+        switch(in.op){
+            // Templated kernels of concrete gates: resolved statically
+            case Opcode::Hadamard:    HadamardR().KernelSpan(amp, size, in.target);                 break;
+            case Opcode::PauliX:      XGateR().KernelSpan(amp, size, in.target);                    break;
+            case Opcode::PauliY:      YGateR().KernelSpan(amp, size, in.target);                    break;
+            case Opcode::Matrix:      ApplyMatrix2(amp, size, in.target, *m);                       break;
+            case Opcode::Controlled:  ApplyControlledMatrix2(amp, size, in.target, in.mask, *m);    break;
+            case Opcode::TensorBlock: ExecuteBlock(amp, size, in.mask, m);                          break;
+            case Opcode::Swap:        ApplySwap(amp, size, in.target, LowestBit(in.mask));          break;
+            case Opcode::Tile:        assert(false && "Tiles do not nest");                         break;
+        }
+    }
+
+    /**
+     * @brief Apply code[first, first + count) to each 2^localQubits slice in turn
+     *
+     * Slices are distributed over the thread pool; the kernels called inside
+     * a slice run serially on that thread (nested ParallelFor).
+     */
+    template <typename T>
+    void ExecuteTile(COMPLEX<T>* amp, uint64_t size, int localQubits, size_t first, uint32_t count) const{
+        const uint64_t block = std::min<uint64_t>(uint64_t(1) << localQubits, size);
+        const uint64_t localMask = block - 1;
+        ThreadPool::Instance().ParallelFor(size / block, 1, [&](uint64_t begin, uint64_t end){
+            for(uint64_t b = begin; b < end; ++b){
+                const uint64_t base = b * block;
+                for(uint32_t k = 0; k < count; ++k){
+                    Instruction in = code[first + k];
+                    if(in.op == Opcode::Controlled){
+                        const uint64_t high = in.mask & ~localMask;
+                        if((base & high) != high) continue;     // A high control is |0⟩ throughout this slice
+                        in.mask &= localMask;
+                    }
+                    ExecuteOne(amp + base, block, in);
+                }
+            }
+        });
+    }
+
+    template <typename T>
+    static void ExecuteBlock(COMPLEX<T>* amp, uint64_t size, uint64_t mask, const Matrix2* factors){
+        int q2[2], q3[3];
+        Matrix2 u2[2], u3[3];
+        int k = 0;
+        for(int b = 0; b < 64 && k < 3; ++b){
+            if((mask >> b) & 1){
+                if(k < 2){ q2[k] = b; u2[k] = factors[k]; }
+                q3[k] = b;
+                u3[k] = factors[k];
+                ++k;
+            }
+        }
+        if(k == 2) ApplyTensorBlock<2>(amp, size, q2, u2);
+        else       ApplyTensorBlock<3>(amp, size, q3, u3);
+    }
+
+    static int LowestBit(uint64_t mask){
+        int b = 0;
+        while(b < 63 && !((mask >> b) & 1)) ++b;
+        return b;
+    }
+
+    /**
+     * @brief Local position to evict for a qubit that must become local at instruction pc
+     * @return Position (< localQubits) whose logical qubit is needed furthest in the future
+     */
+    static int ChooseVictim(const std::vector<uint64_t>& needs, size_t pc, const std::vector<int>& logical, int localQubits){
+        uint64_t remaining = 0;                          // Candidate logical qubits
+        for(int p = 0; p < localQubits; ++p){
+            if(!((needs[pc] >> logical[p]) & 1)) remaining |= uint64_t(1) << logical[p];
+        }
+        assert(remaining && "Instruction needs more qubits than fit in a block");
+        for(size_t k = pc + 1; k < needs.size() && std::bitset<64>(remaining).count() > 1; ++k){
+            uint64_t rest = remaining & ~needs[k];
+            if(rest) remaining = rest;                   // Drop the candidates needed sooner
+            else break;                                  // All remaining needed here: tie
+        }
+        for(int p = localQubits - 1; p >= 0; --p){
+            if((remaining >> logical[p]) & 1) return p;  // Prefer the highest local position
+        }
+        return localQubits - 1;
+    }
+};
+
+/**
+ * @class Circuit
+ * @brief Recorded sequence of register operations
+ *
+ * Builder methods return *this so circuits can be written fluently:
+ * Circuit c(3);
+ * c.H(0).H(1).CNOT(1, 2).T(2).H(0);
+ */
+class Circuit{
+public:
+    explicit Circuit(int n) : bits(n) {}
+
+    Circuit& H(int q) { return Gate(*HadamardR().Matrix(), q); }
+    Circuit& X(int q) { return Gate(*XGateR().Matrix(), q); }
+    Circuit& Y(int q) { return Gate(*YGateR().Matrix(), q); }
+    Circuit& Z(int q) { return Gate(*ZGateR().Matrix(), q); }
+    Circuit& S(int q) { return Gate(*SGateR().Matrix(), q); }
+    Circuit& T(int q) { return Gate(*TGateR().Matrix(), q); }
+
+    /**
+     * @brief Record an arbitrary single-qubit unitary
+     */
+    Circuit& Gate(const Matrix2& u, int q){
+        assert(q >= 0 && q < bits && "Qubit index out of range");
+        ops.push_back({q, 0, u});
+        return *this;
+    }
+
+    /**
+     * @brief Record a register gate that exposes a 2×2 matrix
+     * @throws std::invalid_argument if the gate has none
+     */
+    Circuit& Gate(const RGates& gate, int q){
+        return Gate(FixedMatrix(gate), q);
+    }
+
+    /**
+     * @brief Record a controlled register gate (CNotGateR, CZGateR, ToffoliGateR, ControlledGateR)
+     * @param target Target qubit
+     */
+    Circuit& Gate(const ControlledGateR& gate, int target){
+        std::vector<int> controls;
+        for(int c = 0; c < bits; ++c){
+            if((gate.ControlMask() >> c) & 1) controls.push_back(c);
+        }
+        assert(gate.ControlMask() >> bits == 0 && "Control qubit out of range");
+        return Controlled(gate.TargetMatrix(), target, controls);
+    }
+
+    /**
+     * @brief Record a controlled unitary
+     * @param u Matrix applied to target when all controls are |1⟩
+     * @param target Target qubit
+     * @param controls Control qubits
+     */
+    Circuit& Controlled(const Matrix2& u, int target, const std::vector<int>& controls){
+        uint64_t mask = 0;
+        for(int c : controls){
+            assert(c != target && c >= 0 && c < bits && "Invalid control qubit");
+            mask |= uint64_t(1) << c;
+        }
+        ops.push_back({target, mask, u});
+        return *this;
+    }
+
+    Circuit& CNOT(int control, int target) { return Controlled(*XGateR().Matrix(), target, {control}); }
+    Circuit& CZ(int control, int target) { return Controlled(*ZGateR().Matrix(), target, {control}); }
+    Circuit& Toffoli(int c1, int c2, int target) { return Controlled(*XGateR().Matrix(), target, {c1, c2}); }
+
+    /**
+     * @brief Number of recorded operations
+     */
+    size_t Size() const{
+        return ops.size();
+    }
+
+    /**
+     * @brief Lower the recorded operations into a CompiledCircuit
+     * @param maxBlock Largest fused tensor block (1 disables block fusion)
+     * @param localQubits Cache-block size in qubits for CacheBlocked() (0 = no cache blocking)
+     * @return Flat instruction stream with fusion and kernel selection applied
+     *
+     * Single-qubit operations accumulate in a GateFuser; any controlled
+     * operation first flushes the fuser (its blocks become instructions) so
+     * program order is preserved across multi-qubit gates.
+     *
+     * @complexity Time: O(ops), independent of register size
+     */
+    CompiledCircuit Compile(int maxBlock = 2, int localQubits = 0) const{
+        CompiledCircuit out;
+        out.bits = bits;
+        GateFuser fuser(maxBlock);
+
+        for(const Operation& op : ops){
+            if(op.controls == 0){
+                fuser.Queue(op.u, op.target);
+                continue;
+            }
+            EmitBlocks(out, fuser.TakeBlocks());
+            out.code.push_back({Opcode::Controlled, op.target, op.controls, AddMatrix(out, op.u)});
+        }
+        EmitBlocks(out, fuser.TakeBlocks());
+        return localQubits > 0 ? out.CacheBlocked(localQubits) : out;
+    }
+
+private:
+    /// Recorded operation: single-qubit when controls == 0
+    struct Operation{
+        int target;
+        uint64_t controls;
+        Matrix2 u;
+    };
+
+    int bits;                               ///< Register width
+    std::vector<Operation> ops;             ///< Operations in program order
+
+    static uint32_t AddMatrix(CompiledCircuit& out, const Matrix2& u){
+        out.matrices.push_back(u);
+        return static_cast<uint32_t>(out.matrices.size() - 1);
+    }
+
+    static bool SameMatrix(const Matrix2& a, const Matrix2& b){
+        for(int e = 0; e < 4; ++e){
+            if(std::abs(a.m[e] - b.m[e]) > 1e-12) return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Turn fused blocks into instructions, picking dedicated kernels where possible
+     */
+    static void EmitBlocks(CompiledCircuit& out, const std::vector<GateFuser::FusedBlock>& blocks){
+        for(const auto& block : blocks){
+            if(block.qubits.size() == 1){
+                const Matrix2& u = block.factors[0];
+                Opcode op = Opcode::Matrix;
+                if(SameMatrix(u, *HadamardR().Matrix()))   op = Opcode::Hadamard;
+                else if(SameMatrix(u, *XGateR().Matrix())) op = Opcode::PauliX;
+                else if(SameMatrix(u, *YGateR().Matrix())) op = Opcode::PauliY;
+                out.code.push_back({op, block.qubits[0], 0, AddMatrix(out, u)});
+                continue;
+            }
+            uint64_t mask = 0;
+            uint32_t first = static_cast<uint32_t>(out.matrices.size());
+            for(size_t b = 0; b < block.qubits.size(); ++b){
+                mask |= uint64_t(1) << block.qubits[b];
+                AddMatrix(out, block.factors[b]);
+            }
+            out.code.push_back({Opcode::TensorBlock, block.qubits[0], mask, first});
+        }
+    }
+};
+
+#endif // CIRCUIT_CL_CPP
@@ -38,7 +38,7 @@
 #include <cmath>
 #include <vector>
 
-#include "RegisterGates_cl.cpp"
+#include "RegisterBatch_cl.cpp"
 
 #define COMPLEX std::complex
 
@@ -95,6 +95,9 @@ enum class OracleType{
  * - Applies controlled operations based on function type
  * - Preserves quantum superposition throughout
  * - Enables parallel evaluation of f(0) and f(1)
+ * 
+ * For functions of n input bits (Deutsch–Jozsa, Bernstein–Vazirani) and the
+ * ancilla-free phase oracle see BooleanOracle in Oracle_cl.cpp.
  */
 class DeutschOracle{
     OracleType type;  ///< Type of function this oracle implements
@@ -112,12 +115,15 @@ public:
      * 
      * Implements the unitary transformation U_f |x⟩|y⟩ = |x⟩|y ⊕ f(x)⟩
      * 
-     * Algorithm:
-     * 1. Iterate through all possible computational basis states
-     * 2. For each state |xy⟩, extract x (input) and y (ancilla)
-     * 3. Compute f(x) based on the oracle type
-     * 4. Apply XOR: new_y = y ⊕ f(x)
-     * 5. Swap amplitudes to implement the transformation
+     * Gate Decomposition (qubit 1 = x, qubit 0 = y):
+     * - Constant0: f(x) = 0  → identity (no gate)
+     * - Constant1: f(x) = 1  → X on y
+     * - Identity:  f(x) = x  → CNOT(x → y)
+     * - Not:       f(x) = ¬x → CNOT(x → y) followed by X on y
+     * 
+     * Each case is a permutation of basis states, applied with the register
+     * gate engine instead of a per-index swap loop, so the oracle evaluates
+     * the function type once rather than once per amplitude.
      * 
      * State Evolution:
      * - Input: superposition over all |x⟩|y⟩ states
@@ -126,40 +132,86 @@ public:
      * 
      * Bit Encoding (for 2-qubit register):
      * - State index i: bit representation |x⟩|y⟩
-     * - x = (i >> 1) & 1: extract input qubit (MSB)
-     * - y = i & 1: extract ancilla qubit (LSB)
-     * - j = (x << 1) | new_y: construct new state index
+     * - x = (i >> 1) & 1: input qubit (MSB, qubit index 1)
+     * - y = i & 1: ancilla qubit (LSB, qubit index 0)
+     * 
+     * Works on either precision (Register or RegisterF) and on wider
+     * registers, where the extra qubits are left untouched.
      */
-    void Apply(Register &reg) const{
-        int size = reg.val.size();  // Total number of basis states (2^2 = 4)
+    template <typename T>
+    void Apply(BasicRegister<T> &reg) const{
+        const XGateR X;
+        const CNotGateR CNOT(1);                  // Control on input qubit x
 
-        // Process each computational basis state
-        for(int i = 0; i < size; ++i){
-            // Extract qubit values from state index
-            int x = (i >> 1) & 1;       // Input qubit: 0 or 1
-            int y = i & 1;              // Ancilla qubit: 0 or 1
-            
-            // Evaluate function f(x) based on oracle type
-            int fx = 0;
-            switch (type) {
-                case OracleType::Constant0: fx = 0; break;      // f(x) = 0
-                case OracleType::Constant1: fx = 1; break;      // f(x) = 1
-                case OracleType::Identity:  fx = x; break;      // f(x) = x
-                case OracleType::Not:       fx = !x; break;     // f(x) = ¬x
-            }
-            
-            // Apply oracle transformation: y → y ⊕ f(x)
-            int newY = y ^ fx;                    // XOR operation
-            int j = (x << 1) | newY;              // Construct new state index
-            
-            // Swap amplitudes to implement the unitary transformation
-            // This effectively maps |i⟩ → |j⟩ in the computational basis
-            if (i != j) {  // Only swap if states are different
-                std::swap(reg.val[i], reg.val[j]);
-            }
+        switch (type) {
+            case OracleType::Constant0:                            break;  // y → y
+            case OracleType::Constant1: X.ApplyToSingle(reg, 0);   break;  // y → y ⊕ 1
+            case OracleType::Identity:  CNOT.ApplyToSingle(reg, 0); break; // y → y ⊕ x
+            case OracleType::Not:                                          // y → y ⊕ ¬x
+                CNOT.ApplyToSingle(reg, 0);
+                X.ApplyToSingle(reg, 0);
+                break;
         }
     }
+
+    /**
+     * @brief Apply a different oracle to each state of a batch
+     * @param batch States of at least 2 qubits (x = qubit 1, y = qubit 0)
+     * @param types types[b] is the oracle applied to state b
+     * 
+     * Same decomposition as Apply(), with the CNOT and the X turned into
+     * per-state choices between the gate and the identity, so every oracle
+     * in the batch is evaluated in two sweeps.
+     */
+    template <typename T>
+    static void ApplyEach(BasicRegisterBatch<T> &batch, const std::vector<OracleType> &types){
+        const Matrix2 I{{1.0, 0.0, 0.0, 1.0}};
+        const Matrix2 X{{0.0, 1.0, 1.0, 0.0}};
+        std::vector<Matrix2> cnot(types.size()), flip(types.size());
+        for (size_t b = 0; b < types.size(); ++b) {
+            const bool balanced = types[b] == OracleType::Identity || types[b] == OracleType::Not;
+            const bool negated = types[b] == OracleType::Constant1 || types[b] == OracleType::Not;
+            cnot[b] = balanced ? X : I;             // y → y ⊕ x
+            flip[b] = negated ? X : I;              // y → y ⊕ 1
+        }
+        batch.ApplyControlledEach(0, uint64_t(1) << 1, cnot);
+        batch.ApplyMatrixEach(0, flip);
+    }
+
+    /**
+     * @brief Oracle known at compile time, on a 2-qubit register
+     * @tparam Type Function to apply
+     * 
+     * Same decomposition as Apply(), built from the specialised kernels of
+     * StaticGates_cl.cpp: the gate choice, qubits and register width are all
+     * template parameters, so no branch or virtual call survives.
+     */
+    template <OracleType Type, typename T>
+    static void ApplyFixed(BasicRegister<T> &reg){
+        if constexpr (Type == OracleType::Identity || Type == OracleType::Not)
+            ApplyStatic<StaticPauliX, 0, 2, 0b10>(reg);    // CNOT(x → y)
+        if constexpr (Type == OracleType::Constant1 || Type == OracleType::Not)
+            ApplyStatic<StaticPauliX, 0, 2>(reg);          // X on y
+    }
 };
+/**
+ * @brief Deutsch's circuit with the oracle fixed at compile time
+ * @tparam Type Function to test
+ * @return Measured input qubit x: 0 for a constant f, 1 for a balanced one
+ * 
+ * |01⟩ → H⊗H → U_f → H on x, every gate an ApplyStatic<Gate, qubit, 2>
+ * kernel over the four amplitudes.
+ */
+template <OracleType Type>
+int RunDeutschFixed() {
+    Register reg(2);
+    ApplyStatic<StaticPauliX, 0, 2>(reg);                  // |01⟩
+    ApplyStatic<StaticHadamard, 1, 2>(reg);
+    ApplyStatic<StaticHadamard, 0, 2>(reg);
+    DeutschOracle::ApplyFixed<Type>(reg);
+    ApplyStatic<StaticHadamard, 1, 2>(reg);
+    return static_cast<int>((reg.MeasureIndex() >> 1) & 1);
+}
 /**
  * @brief Execute Deutsch's Algorithm to determine if a function is constant or balanced
  * @param isConstant Expected result (true if function should be constant, false if balanced)
@@ -214,8 +266,8 @@ void RunDeutschAlgorithm(bool isConstant) {
     // Creates superposition: (|00⟩ - |01⟩ + |10⟩ - |11⟩)/2
     // This enables quantum parallelism - both f(0) and f(1) will be evaluated simultaneously
     HadamardR H;
-    H.ApplyToSingle(reg, 0);  // H on input qubit
-    H.ApplyToSingle(reg, 1);  // H on ancilla qubit
+    H.ApplyToSingle(reg, 1);  // H on input qubit x (bit 1, leftmost in "01")
+    H.ApplyToSingle(reg, 0);  // H on ancilla qubit y (bit 0)
     std::cout << "\nStep 2 - After applying H⊗H (superposition created):" << std::endl;
     reg.Print();
 
@@ -229,7 +281,7 @@ void RunDeutschAlgorithm(bool isConstant) {
     // Step 4: Apply Hadamard to the first qubit only
     // This creates interference between the |0⟩ and |1⟩ components
     // The interference pattern depends on whether f is constant or balanced
-    H.ApplyToSingle(reg, 0);
+    H.ApplyToSingle(reg, 1);  // Input qubit x is bit 1
     std::cout << "\nStep 4 - After final Hadamard on input qubit:" << std::endl;
     reg.Print();
 
@@ -276,6 +328,9 @@ void RunDeutschAlgorithm(bool isConstant) {
  * - Shows algorithm works for all possible functions
  * - Demonstrates the deterministic nature of quantum measurement
  * - Illustrates the theoretical foundations of quantum advantage
+ * 
+ * The four runs share one RegisterBatch (one state per function), so each
+ * gate of the circuit is a single sweep over all of them.
  */
 void DemonstrateAllFunctions() {
     std::cout << "\n" << std::string(60, '=') << std::endl;
@@ -297,29 +352,28 @@ void DemonstrateAllFunctions() {
         {OracleType::Not, "NOT", false, "f(x) = ¬x"}
     };
     
-    for (const auto& func : functions) {
+    // Run algorithm on all functions at once: |01⟩ → H⊗H → U_f → H on x
+    std::vector<OracleType> types;
+    for (const auto& func : functions) types.push_back(func.type);
+    RegisterBatch batch(2, functions.size());
+    batch.ApplyGate(XGateR(), 0);
+    HadamardR H;
+    batch.ApplyGate(H, 1);
+    batch.ApplyGate(H, 0);
+    DeutschOracle::ApplyEach(batch, types);
+    batch.ApplyGate(H, 1);
+    std::vector<uint64_t> measured = batch.MeasureIndex();
+    
+    for (size_t f = 0; f < functions.size(); ++f) {
+        const auto& func = functions[f];
         std::cout << "\n" << std::string(40, '-') << std::endl;
         std::cout << "Testing Function: " << func.name << std::endl;
         std::cout << "Description: " << func.description << std::endl;
         std::cout << "Type: " << (func.isConstant ? "CONSTANT" : "BALANCED") << std::endl;
         std::cout << std::string(40, '-') << std::endl;
         
-        // Run algorithm with specific oracle
-        Register reg(2, {{"01", std::complex<double>(1.0, 0.0)}});
-        
-        // Apply algorithm steps
-        HadamardR H;
-        H.ApplyToSingle(reg, 0);
-        H.ApplyToSingle(reg, 1);
-        
-        DeutschOracle oracle(func.type);
-        oracle.Apply(reg);
-        
-        H.ApplyToSingle(reg, 0);
-        
-        // Measure and analyze
-        std::string measurement = reg.MeasureWithoutCollapse();
-        int result = measurement[0] - '0';
+        // Measured input qubit x (qubit 1) of this function's state
+        int result = static_cast<int>((measured[f] >> 1) & 1);
         
         std::cout << "Measurement result: " << result << std::endl;
         std::cout << "Expected for " << (func.isConstant ? "constant" : "balanced") 
@@ -328,6 +382,14 @@ void DemonstrateAllFunctions() {
         bool correct = (func.isConstant && result == 0) || (!func.isConstant && result == 1);
         std::cout << (correct ? "✅ CORRECT" : "❌ INCORRECT") << " identification!" << std::endl;
     }
+
+    // Same four circuits with the oracle fixed at compile time
+    const int fixed[] = {RunDeutschFixed<OracleType::Constant0>(), RunDeutschFixed<OracleType::Constant1>(),
+                         RunDeutschFixed<OracleType::Identity>(), RunDeutschFixed<OracleType::Not>()};
+    bool agree = true;
+    for (size_t f = 0; f < functions.size(); ++f)
+        agree = agree && fixed[f] == (functions[f].isConstant ? 0 : 1);
+    std::cout << "\nCompile-time circuits: " << (agree ? "✅ all four agree" : "❌ mismatch") << std::endl;
 }
 
 /**
@@ -0,0 +1,463 @@
+/**
+ * @file DistributedRegister_cl.cpp
+ * @brief State vector sharded across MPI ranks by its top qubits
+ *
+ * One node tops out around 32–34 qubits in double precision (2^34 × 16 B =
+ * 256 GiB). DistributedRegister splits the 2^n amplitudes over P = 2^g MPI
+ * ranks: the top g qubits are "global" and select the rank, the remaining
+ * n - g "local" qubits index into that rank's shard:
+ *
+ *     global index i = (rank << localBits) | local index
+ *
+ * Each shard is an ordinary BasicRegister<T>, so within a rank every kernel
+ * (SIMD, thread pool, subspace enumeration) is reused unchanged:
+ * - Gate on a local qubit: the existing register kernel on the shard, no communication
+ * - Diagonal gate on a global qubit: each rank scales its shard by u00 or u11
+ *   according to its own rank bit, no communication
+ * - Other gate on a global qubit q: rank r pairs with r ⊕ 2^(q - localBits);
+ *   the partners swap shards chunk by chunk (MPI_Sendrecv) and each keeps
+ *   its half of the 2×2 product
+ * - Controls on global qubits are decided per rank (all-or-nothing for the shard)
+ * - MagnitudeSquareSum / Normalise / measurement use MPI_Allreduce and
+ *   MPI_Allgather over per-shard sums
+ *
+ * Build and run (requires an MPI implementation; not part of the default build):
+ * mpicxx -std=c++17 -O2 -march=native -pthread program.cpp -o program
+ * mpirun -np 4 ./program
+ *
+ * Usage (MPI_Init must have been called):
+ * DistributedRegister<double> reg(36);            // 4 ranks → 2^34 amplitudes each
+ * reg.ApplyGate(HadamardR(), 35);                  // Global qubit: pairwise exchange
+ * reg.ApplyGate(CNotGateR(35), 0);                 // Global control: local work only
+ * uint64_t outcome = reg.MeasureIndex();           // Same result on every rank
+ *
+ * Every rank must make the same sequence of calls (the gates and measurements
+ * are collective operations).
+ *
+ * @author Your Name
+ * @date 2025
+ */
+
+#ifndef DISTRIBUTED_REGISTER_CL_CPP
+#define DISTRIBUTED_REGISTER_CL_CPP
+
+#include <mpi.h>
+
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <vector>
+
+#include "RegisterGates_cl.cpp"
+
+/// Amplitudes exchanged per MPI_Sendrecv: 2^20 × 16 B = 16 MiB, bounding the receive buffer
+constexpr uint64_t kExchangeChunk = uint64_t(1) << 20;
+
+/**
+ * @class DistributedRegister
+ * @brief Quantum register whose state vector is split across the ranks of a communicator
+ * @tparam T Amplitude scalar type (double or float)
+ */
+template <typename T>
+class DistributedRegister
+{
+public:
+    using Amplitude = COMPLEX<T>;                   ///< Stored amplitude type
+    using RandomEngine = Xoshiro256;                ///< Engine type driving measurement draws
+
+    int bits;                                       ///< Total number of qubits n
+    int localBits;                                  ///< Qubits held inside each shard (n - g)
+
+    /**
+     * @brief Create an n-qubit register in |00...0⟩ distributed over comm
+     * @param n Total number of qubits; needs n - g ≥ 1 local qubits for P = 2^g ranks
+     * @param comm Communicator whose size must be a power of two
+     * @throws std::length_error if one shard exceeds the per-node memory budget
+     */
+    explicit DistributedRegister(int n, MPI_Comm comm = MPI_COMM_WORLD)
+        : bits(n), localBits(n - GlobalBits(comm)), comm(comm), shard(n - GlobalBits(comm))
+    {
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &ranks);
+        assert(localBits >= 1 && "Each rank needs at least one local qubit");
+        if (rank != 0)
+        {
+            shard.val[0] = Amplitude(0, 0);                 // |0...0⟩ lives on rank 0
+            shard.MarkDirty();
+        }
+
+        uint64_t seed = RandomEngine::FromEntropy()();      // One shared measurement stream
+        MPI_Bcast(&seed, 1, MPI_UINT64_T, 0, comm);
+        Seed(seed);
+    }
+
+    /**
+     * @brief This process's rank and the number of ranks
+     */
+    int Rank() const { return rank; }
+    int Ranks() const { return ranks; }
+
+    /**
+     * @brief The local shard: amplitudes (rank << localBits) ... + 2^localBits - 1
+     */
+    BasicRegister<T> &Shard() { return shard; }
+    const BasicRegister<T> &Shard() const { return shard; }
+
+    /**
+     * @brief Apply a gate to one qubit
+     * @param gate Any register gate for local qubits; global qubits need a fixed Matrix()
+     * @param qubitIndex Target qubit (0 to n - 1)
+     * @throws std::invalid_argument if a global qubit's gate has no matrix (controlled gates take the overload below)
+     */
+    void ApplyGate(const RGates &gate, int qubitIndex)
+    {
+        if (qubitIndex < localBits)
+        {
+            gate.ApplyToSingle(shard, qubitIndex);
+            return;
+        }
+        ApplyControlled(qubitIndex, 0, FixedMatrix(gate));
+    }
+
+    /**
+     * @brief Apply a controlled gate (CNotGateR, ToffoliGateR, ...) with the given target
+     */
+    void ApplyGate(const ControlledGateR &gate, int qubitIndex)
+    {
+        ApplyControlled(qubitIndex, gate.ControlMask(), gate.TargetMatrix());
+    }
+
+    /**
+     * @brief Apply a gate to every qubit in turn
+     */
+    void Apply(const RGates &gate)
+    {
+        for (int q = 0; q < bits; ++q)
+            ApplyGate(gate, q);
+    }
+
+    /**
+     * @brief Apply u to the target qubit when every qubit in controlMask is |1⟩
+     * @param targetIndex Target qubit, local or global
+     * @param controlMask Control qubits, local and/or global (0 = uncontrolled)
+     * @param u Gate matrix
+     *
+     * Global controls depend only on the rank, so a rank whose bits fail them
+     * skips the gate entirely — together with its exchange partner, which has
+     * the same global control bits.
+     */
+    void ApplyControlled(int targetIndex, uint64_t controlMask, const Matrix2 &u)
+    {
+        const uint64_t localMask = (uint64_t(1) << localBits) - 1;
+        const uint64_t globalControls = controlMask >> localBits;
+        const uint64_t localControls = controlMask & localMask;
+        assert(!((controlMask >> targetIndex) & 1) && "Target qubit cannot also be a control");
+        if ((uint64_t(rank) & globalControls) != globalControls)
+            return;                                         // Controls fail for the whole shard
+
+        if (targetIndex < localBits)
+        {
+            ApplyControlledMatrix2(shard, targetIndex, localControls, u);
+            return;
+        }
+
+        const int globalBit = targetIndex - localBits;
+        const bool upper = (rank >> globalBit) & 1;         // This rank holds the target = 1 half
+        if (u.IsDiagonal())
+        {
+            const COMPLEX<double> phase = upper ? u.m[3] : u.m[0];
+            if (std::abs(phase - 1.0) > 1e-15)
+                ScaleShard(localControls, phase);
+            return;
+        }
+        ExchangeAndMix(rank ^ (1 << globalBit), upper, localControls, u);
+    }
+
+    /**
+     * @brief Exchange two qubit positions (local kernel, or three CNOTs if a qubit is global)
+     */
+    void ApplySwap(int qubitA, int qubitB)
+    {
+        assert(qubitA != qubitB && "Swap needs two distinct qubits");
+        if (qubitA < localBits && qubitB < localBits)
+        {
+            ::ApplySwap(shard, qubitA, qubitB);
+            return;
+        }
+        const Matrix2 x{{0.0, 1.0, 1.0, 0.0}};
+        ApplyControlled(qubitB, uint64_t(1) << qubitA, x);
+        ApplyControlled(qubitA, uint64_t(1) << qubitB, x);
+        ApplyControlled(qubitB, uint64_t(1) << qubitA, x);
+    }
+
+    /**
+     * @brief Σ |αᵢ|² over all ranks (collective)
+     */
+    double MagnitudeSquareSum() const
+    {
+        double local = shard.MagnitudeSquareSum();
+        double total = 0.0;
+        MPI_Allreduce(&local, &total, 1, MPI_DOUBLE, MPI_SUM, comm);
+        return total;
+    }
+
+    /**
+     * @brief Rescale every shard so Σ |αᵢ|² = 1 across ranks (collective)
+     * @return The global magnitude square sum before normalisation
+     */
+    double Normalise()
+    {
+        double total = MagnitudeSquareSum();
+        ScaleShard(0, COMPLEX<double>(1.0 / std::sqrt(total), 0.0));
+        shard.MarkDirty();                                  // Not a unit phase: the shard's cached norm is stale
+        return total;
+    }
+
+    /**
+     * @brief Born-rule probability of global basis state |i⟩, returned on every rank (collective)
+     */
+    double GetProbab(uint64_t i) const
+    {
+        const int owner = static_cast<int>(i >> localBits);
+        double p = owner == rank ? shard.GetProbab(i & ((uint64_t(1) << localBits) - 1)) : 0.0;
+        MPI_Bcast(&p, 1, MPI_DOUBLE, owner, comm);
+        return p;
+    }
+
+    /**
+     * @brief Non-collapsing measurement; the same index is returned on every rank (collective)
+     *
+     * Algorithm:
+     * 1. Allgather the per-shard norms; one shared draw picks the owning rank
+     * 2. The owner draws the local index from its shard (MeasureIndex)
+     * 3. The owner broadcasts the global index
+     * All ranks advance the shared engine identically, so later draws stay in step.
+     */
+    uint64_t MeasureIndex()
+    {
+        const int owner = DrawRank();
+        uint64_t index = 0;
+        if (owner == rank)
+        {
+            RandomEngine draw = rng;                        // Same state on every rank
+            index = (uint64_t(rank) << localBits) | shard.MeasureIndex(draw);
+        }
+        rng.UniformDouble();                                // Consume the owner's draw everywhere
+        MPI_Bcast(&index, 1, MPI_UINT64_T, owner, comm);
+        return index;
+    }
+
+    /**
+     * @brief Collapsing measurement (collective): every shard but the owner's becomes zero
+     */
+    uint64_t CollapseIndex()
+    {
+        uint64_t index = MeasureIndex();
+        Amplitude *amp = shard.val.data();
+        ThreadPool::Instance().ParallelFor(shard.val.size(), kAmplitudesPerReduceChunk, [=](uint64_t begin, uint64_t end) {
+            std::fill(amp + begin, amp + end, Amplitude(0, 0));
+        });
+        if (static_cast<int>(index >> localBits) == rank)
+            amp[index & ((uint64_t(1) << localBits) - 1)] = Amplitude(1, 0);
+        shard.MarkDirty();
+        return index;
+    }
+
+    /**
+     * @brief Draw many shots; the full histogram is returned on root (collective)
+     * @param shots Total number of shots
+     * @param root Rank receiving the merged histogram (other ranks get their own part)
+     *
+     * The shot count of each rank is drawn once from the shard norms (shared
+     * engine), then every rank samples its share from its own shard with a
+     * per-rank stream, and the partial histograms are gathered on root.
+     */
+    std::map<uint64_t, size_t> Sample(size_t shots, int root = 0)
+    {
+        std::vector<double> cumulative = ShardCumulative();
+        std::vector<uint64_t> perRank(ranks, 0);
+        for (size_t shot = 0; shot < shots; ++shot)
+            ++perRank[PickRank(cumulative, rng.UniformDouble())];
+
+        std::vector<uint64_t> flat;                         // (global index, count) pairs
+        for (const auto &[index, count] : shard.Sample(perRank[rank], localRng))
+        {
+            flat.push_back((uint64_t(rank) << localBits) | index);
+            flat.push_back(count);
+        }
+
+        int mine = static_cast<int>(flat.size());
+        std::vector<int> sizes(ranks), offsets(ranks, 0);
+        MPI_Gather(&mine, 1, MPI_INT, sizes.data(), 1, MPI_INT, root, comm);
+        std::vector<uint64_t> all;
+        if (rank == root)
+        {
+            for (int r = 1; r < ranks; ++r)
+                offsets[r] = offsets[r - 1] + sizes[r - 1];
+            all.resize(offsets[ranks - 1] + sizes[ranks - 1]);
+        }
+        MPI_Gatherv(flat.data(), mine, MPI_UINT64_T, all.data(), sizes.data(), offsets.data(), MPI_UINT64_T, root, comm);
+
+        const std::vector<uint64_t> &pairs = rank == root ? all : flat;
+        std::map<uint64_t, size_t> histogram;
+        for (size_t k = 0; k + 1 < pairs.size(); k += 2)
+            histogram.emplace(pairs[k], pairs[k + 1]);
+        return histogram;
+    }
+
+    /**
+     * @brief Seed the shared measurement stream (call with the same seed on every rank)
+     */
+    void Seed(uint64_t seed)
+    {
+        rng.Seed(seed, 0);
+        localRng.Seed(seed, uint64_t(rank) + 1);
+    }
+
+    /**
+     * @brief Collect the full state vector on root (for checks on small registers)
+     * @return All 2^n amplitudes on root, an empty vector elsewhere (collective)
+     */
+    std::vector<Amplitude> Gather(int root = 0) const
+    {
+        std::vector<Amplitude> all(rank == root ? (uint64_t(1) << bits) : 0);
+        const uint64_t shardSize = shard.val.size();
+        for (uint64_t done = 0; done < shardSize; done += kExchangeChunk)
+        {
+            const int len = static_cast<int>(std::min(kExchangeChunk, shardSize - done) * sizeof(Amplitude));
+            if (rank == root)
+            {
+                for (int r = 0; r < ranks; ++r)
+                {
+                    char *dst = reinterpret_cast<char *>(all.data() + (uint64_t(r) << localBits) + done);
+                    if (r == root)
+                        std::copy_n(reinterpret_cast<const char *>(shard.val.data() + done), len, dst);
+                    else
+                        MPI_Recv(dst, len, MPI_BYTE, r, 0, comm, MPI_STATUS_IGNORE);
+                }
+            }
+            else
+            {
+                MPI_Send(shard.val.data() + done, len, MPI_BYTE, root, 0, comm);
+            }
+        }
+        return all;
+    }
+
+private:
+    MPI_Comm comm;                                  ///< Communicator over the shards
+    int rank = 0;                                   ///< This process's shard number
+    int ranks = 1;                                  ///< Number of shards P = 2^g
+    BasicRegister<T> shard;                         ///< Local 2^(n-g) amplitudes
+    RandomEngine rng;                               ///< Shared stream (identical on all ranks)
+    RandomEngine localRng;                          ///< Per-rank stream for in-shard sampling
+
+    /**
+     * @brief g = log2(communicator size); the size must be a power of two
+     */
+    static int GlobalBits(MPI_Comm comm)
+    {
+        int size = 1;
+        MPI_Comm_size(comm, &size);
+        assert(size > 0 && (size & (size - 1)) == 0 && "Rank count must be a power of two");
+        int g = 0;
+        while ((1 << g) < size)
+            ++g;
+        return g;
+    }
+
+    /**
+     * @brief Multiply the shard's control-satisfied amplitudes by a phase
+     *
+     * Keeps the shard's cached norm, which is only right for |phase| = 1;
+     * callers scaling by anything else must MarkDirty() the shard.
+     */
+    void ScaleShard(uint64_t localControls, COMPLEX<double> phase)
+    {
+        const Amplitude p(phase);
+        Amplitude *amp = shard.val.data();
+        ThreadPool::Instance().ParallelFor(shard.val.size(), kAmplitudesPerReduceChunk, [=](uint64_t begin, uint64_t end) {
+            for (uint64_t i = begin; i < end; ++i)
+            {
+                if ((i & localControls) == localControls)
+                    amp[i] *= p;
+            }
+        });
+        shard.MarkDirty(true);                              // |phase| = 1
+    }
+
+    /**
+     * @brief Swap shards with partner chunk by chunk and keep this rank's half of u·(α₀, α₁)
+     * @param partner Rank holding the other half of every amplitude pair
+     * @param upper True if this rank holds the target = 1 amplitudes (α₁)
+     *
+     * Per chunk: MPI_Sendrecv our amplitudes for theirs, then
+     *   lower rank: α₀ ← u00·α₀ + u01·α₁(theirs)
+     *   upper rank: α₁ ← u10·α₀(theirs) + u11·α₁
+     * Communication volume: one shard each way; buffer: kExchangeChunk amplitudes.
+     */
+    void ExchangeAndMix(int partner, bool upper, uint64_t localControls, const Matrix2 &u)
+    {
+        const Amplitude mine(upper ? u.m[3] : u.m[0]);      // Coefficient of our own amplitude
+        const Amplitude theirs(upper ? u.m[2] : u.m[1]);    // Coefficient of the partner's amplitude
+        const uint64_t shardSize = shard.val.size();
+        std::vector<Amplitude> received(std::min(kExchangeChunk, shardSize));
+        Amplitude *amp = shard.val.data();
+
+        for (uint64_t done = 0; done < shardSize; done += kExchangeChunk)
+        {
+            const uint64_t len = std::min(kExchangeChunk, shardSize - done);
+            const int bytes = static_cast<int>(len * sizeof(Amplitude));
+            MPI_Sendrecv(amp + done, bytes, MPI_BYTE, partner, 1,
+                         received.data(), bytes, MPI_BYTE, partner, 1, comm, MPI_STATUS_IGNORE);
+            const Amplitude *other = received.data();
+            ThreadPool::Instance().ParallelFor(len, kAmplitudesPerReduceChunk, [=](uint64_t begin, uint64_t end) {
+                for (uint64_t k = begin; k < end; ++k)
+                {
+                    if (((done + k) & localControls) == localControls)
+                        amp[done + k] = mine * amp[done + k] + theirs * other[k];
+                }
+            });
+        }
+        shard.MarkDirty();                                  // Norm moves between the two shards
+    }
+
+    /**
+     * @brief Running sums of the shard norms, identical on every rank (collective)
+     */
+    std::vector<double> ShardCumulative() const
+    {
+        double local = shard.MagnitudeSquareSum();
+        std::vector<double> norms(ranks);
+        MPI_Allgather(&local, 1, MPI_DOUBLE, norms.data(), 1, MPI_DOUBLE, comm);
+        for (int r = 1; r < ranks; ++r)
+            norms[r] += norms[r - 1];
+        return norms;
+    }
+
+    /**
+     * @brief First rank whose cumulative norm exceeds r·total (skipping empty shards)
+     */
+    static int PickRank(const std::vector<double> &cumulative, double r)
+    {
+        const double target = r * cumulative.back();
+        int last = 0;
+        for (size_t k = 0; k < cumulative.size(); ++k)
+        {
+            const double before = k ? cumulative[k - 1] : 0.0;
+            if (cumulative[k] > before)
+                last = static_cast<int>(k);
+            if (cumulative[k] > target)
+                return static_cast<int>(k);
+        }
+        return last;
+    }
+
+    int DrawRank()
+    {
+        return PickRank(ShardCumulative(), rng.UniformDouble());
+    }
+};
+
+#endif // DISTRIBUTED_REGISTER_CL_CPP
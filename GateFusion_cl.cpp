@@ -0,0 +1,213 @@
+/**
+ * @file GateFusion_cl.cpp
+ * @brief Gate fusion stage: merge queued single-qubit gates into few state sweeps
+ *
+ * Every RGates::ApplyToSingle call streams the whole 2^n state vector through
+ * memory once, and for large registers that traffic — not arithmetic — is the
+ * cost. Gate fusion trades cheap 2×2 / 4×4 / 8×8 matrix products for sweeps:
+ *
+ * 1. Same-qubit fusion: consecutive gates on one qubit multiply into one 2×2
+ *    unitary, e.g. H·T·H·S on qubit 3 → U₃ = S·H·T·H (one pass instead of four).
+ *    Single-qubit gates on different qubits commute, so interleaved gates on
+ *    other qubits do not break a run.
+ * 2. Block fusion: the fused unitaries of up to three neighbouring qubits form
+ *    one 4×4 or 8×8 tensor-product block, applied in a single sweep with
+ *    ApplyTensorBlock.
+ *
+ * Example: H⊗n on 24 qubits becomes 12 sweeps of 4×4 blocks instead of 24 passes
+ * (8 sweeps of 8×8 blocks with maxBlock = 3).
+ *
+ * Usage:
+ * GateFuser fuser;
+ * fuser.Queue(HadamardR(), 0);
+ * fuser.Queue(TGateR(), 0);
+ * fuser.Queue(HadamardR(), 1);
+ * fuser.Flush(reg);            // One 4×4 sweep over qubits {0, 1}
+ *
+ * @author Your Name
+ * @date 2025
+ */
+
+#ifndef GATE_FUSION_CL_CPP
+#define GATE_FUSION_CL_CPP
+
+#include <cassert>
+#include <map>
+#include <vector>
+
+#include "RegisterGates_cl.cpp"
+
+/**
+ * @class GateFuser
+ * @brief Queue of single-qubit unitaries applied as fused blocks on Flush()
+ */
+class GateFuser
+{
+public:
+    /**
+     * @brief Create a fuser
+     * @param maxBlock Largest block size in qubits (1 = same-qubit fusion only, up to 3)
+     *
+     * Two-qubit blocks are the default: they halve the sweeps while the
+     * per-run arithmetic still keeps pace with memory on a single core.
+     */
+    explicit GateFuser(int maxBlock = 2) : maxBlockQubits(maxBlock)
+    {
+        assert(maxBlock >= 1 && maxBlock <= 3 && "Fused blocks span 1 to 3 qubits");
+    }
+
+    /**
+     * @brief Queue a gate matrix on a qubit
+     * @param u 2×2 unitary
+     * @param qubitIndex Target qubit
+     *
+     * The matrix is folded into the qubit's pending unitary immediately
+     * (pending = u · pending), so queue memory stays O(qubits touched).
+     */
+    void Queue(const Matrix2 &u, int qubitIndex)
+    {
+        auto it = pending.find(qubitIndex);
+        if (it == pending.end())
+            pending.emplace(qubitIndex, u);
+        else
+            it->second = u * it->second;            // Later gate multiplies from the left
+        ++queuedGates;
+    }
+
+    /**
+     * @brief Queue a register gate on a qubit
+     * @param gate Gate providing a 2×2 matrix via RGates::Matrix()
+     * @param qubitIndex Target qubit
+     * @throws std::invalid_argument if the gate has no matrix (controlled gates cannot be fused)
+     */
+    void Queue(const RGates &gate, int qubitIndex)
+    {
+        Queue(FixedMatrix(gate), qubitIndex);
+    }
+
+    /**
+     * @brief A group of neighbouring qubits whose fused unitaries run in one sweep
+     */
+    struct FusedBlock
+    {
+        std::vector<int> qubits;                    ///< Ascending qubit indices (1 to 3)
+        std::vector<Matrix2> factors;               ///< factors[b] acts on qubits[b]
+    };
+
+    /**
+     * @brief Group the pending unitaries into sweep-sized blocks and clear the queue
+     * @return Blocks in ascending qubit order (all commute with each other)
+     *
+     * Algorithm:
+     * 1. Drop qubits whose fused unitary is the identity (e.g. H·H)
+     * 2. Walk the remaining qubits in ascending order and greedily group
+     *    neighbours whose indices fit inside a window of maxBlockQubits bits
+     *
+     * Exposed separately from Flush() so compiled circuits can turn the same
+     * blocks into instructions instead of applying them immediately.
+     */
+    std::vector<FusedBlock> TakeBlocks()
+    {
+        std::vector<std::pair<int, Matrix2>> active;
+        for (const auto &[qubit, u] : pending)
+        {
+            if (!u.IsIdentity())
+                active.emplace_back(qubit, u);      // std::map → ascending qubit order
+        }
+
+        std::vector<FusedBlock> blocks;
+        size_t start = 0;
+        while (start < active.size())
+        {
+            size_t end = start + 1;
+            while (end < active.size() && static_cast<int>(end - start) < maxBlockQubits &&
+                   active[end].first - active[start].first < maxBlockQubits)
+            {
+                ++end;
+            }
+
+            FusedBlock block;
+            for (size_t b = start; b < end; ++b)
+            {
+                block.qubits.push_back(active[b].first);
+                block.factors.push_back(active[b].second);
+            }
+            blocks.push_back(std::move(block));
+            start = end;
+        }
+
+        pending.clear();
+        queuedGates = 0;
+        return blocks;
+    }
+
+    /**
+     * @brief Apply all pending gates to the register and clear the queue
+     * @param reg Register to update
+     * @return Number of state-vector sweeps performed
+     *
+     * Single-qubit blocks use ApplyMatrix2 (SIMD, diagonal fast path); larger
+     * blocks are applied as one tensor block by ApplyTensorBlock.
+     */
+    template <typename T>
+    int Flush(BasicRegister<T> &reg)
+    {
+        std::vector<FusedBlock> blocks = TakeBlocks();
+        for (const FusedBlock &block : blocks)
+        {
+            ApplyBlock(reg, block);
+        }
+        return static_cast<int>(blocks.size());
+    }
+
+    /**
+     * @brief Apply one fused block in a single sweep
+     */
+    template <typename T>
+    static void ApplyBlock(BasicRegister<T> &reg, const FusedBlock &block)
+    {
+        switch (block.qubits.size())
+        {
+        case 1: ApplyMatrix2(reg, block.qubits[0], block.factors[0]); break;
+        case 2: ApplyBlockK<2>(reg, block.qubits.data(), block.factors.data()); break;
+        default: ApplyBlockK<3>(reg, block.qubits.data(), block.factors.data()); break;
+        }
+    }
+
+    /**
+     * @brief Apply K fused unitaries on neighbouring qubits as one tensor block
+     * @param qubits K ascending qubit indices
+     * @param factors factors[b] acts on qubits[b]
+     *
+     * The block U_{K-1} ⊗ ... ⊗ U_0 is applied in factored form by
+     * ApplyTensorBlock: one memory sweep, 2·K multiplies per amplitude rather
+     * than the 2^K of an expanded dense matrix.
+     */
+    template <int K, typename T>
+    static void ApplyBlockK(BasicRegister<T> &reg, const int *qubits, const Matrix2 *factors)
+    {
+        int q[K];
+        Matrix2 u[K];
+        for (int b = 0; b < K; ++b)
+        {
+            q[b] = qubits[b];
+            u[b] = factors[b];
+        }
+        ApplyTensorBlock<K>(reg, q, u);
+    }
+
+    /**
+     * @brief Number of gates queued since the last Flush()
+     */
+    size_t QueuedGates() const
+    {
+        return queuedGates;
+    }
+
+private:
+    int maxBlockQubits;                             ///< Largest fused block (qubits)
+    std::map<int, Matrix2> pending;                 ///< Fused unitary per touched qubit
+    size_t queuedGates = 0;                         ///< Gates folded into pending
+};
+
+#endif // GATE_FUSION_CL_CPP
@@ -0,0 +1,447 @@
+/**
+ * @file MeasurementSink_cl.cpp
+ * @brief Buffered measurement sink: packed shots, on-the-fly histograms, batched export
+ *
+ * The measurement calls return one std::string per shot, built bit by bit,
+ * and callers then stream those strings through std::ofstream. For millions
+ * of shots that formatting and stream churn costs far more than the draw
+ * itself. MeasurementSink instead records each shot as its packed basis index:
+ *
+ * 1. Record() appends the index to a fixed-size shot buffer (no allocation)
+ * 2. When the buffer is full, the whole batch is drained at once:
+ *    - counted into the running histogram (dense array for small registers)
+ *    - optionally written out as raw shots, formatted batch-wise into one
+ *      contiguous block and handed to the file in a single write
+ * 3. WriteHistogramCSV() emits the aggregated counts in the exact
+ *    "Measurement,Count" format plotter.py reads, so plotting a million-shot
+ *    run reads 2^n rows at most instead of a million
+ *
+ * Raw shot formats (ShotFormat):
+ * - CSV:    "Shot,Measurement" then one "k,0101" row per shot
+ * - Binary: columnar, see below — 1/2/4/8 bytes per shot instead of n+1 characters
+ *
+ * Binary shot file layout (host byte order, recorded in the header):
+ *     offset 0   ShotFileHeader (32 B): magic "QSHOTS\0\1", byte-order mark,
+ *                qubits, bytes per shot, shot count
+ *     offset 32  shot column: count × uint{8,16,32,64} basis indices
+ * e.g. numpy.fromfile(path, dtype=numpy.uint16, offset=32) for 9–16 qubits.
+ *
+ * Usage:
+ * MeasurementSink sink(reg.bits, ShotFormat::Binary, "shots.bin");
+ * RecordSamples(reg, 1000000, sink);          // Or sink.Record(index) per shot
+ * sink.WriteHistogramCSV("collapse_measurements.csv");
+ *
+ * @author Your Name
+ * @date 2025
+ */
+
+#ifndef MEASUREMENT_SINK_CL_CPP
+#define MEASUREMENT_SINK_CL_CPP
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Quantum_registers_cl.cpp"
+
+/// Shots buffered before a batch is drained: 65536 × 8 B = 512 KiB
+constexpr size_t kShotBufferCapacity = size_t(1) << 16;
+
+/// Registers up to this size count into a dense 2^n array (≤ 8 MiB) instead of a hash map
+constexpr int kDenseHistogramQubits = 20;
+
+/**
+ * @brief Write a histogram in the Measurement,Count CSV format read by plotter.py
+ * @param counts Basis index → count
+ * @param bits Register size n (bitstrings are n characters, MSB first)
+ * @param filename Output path
+ * @return true if the file was written successfully
+ *
+ * Formats the whole file into one buffer and writes it in a single call.
+ */
+inline bool WriteHistogramCSV(const std::map<uint64_t, size_t> &counts, int bits, const std::string &filename)
+{
+    std::string block = "Measurement,Count\n";
+    block.reserve(block.size() + counts.size() * (bits + 12));
+    for (const auto &[index, count] : counts)
+    {
+        for (int j = bits - 1; j >= 0; --j)
+            block += ((index >> j) & 1) ? '1' : '0';       // Bit j at position n-1-j
+        block += ',';
+        block += std::to_string(count);
+        block += '\n';
+    }
+    std::ofstream out(filename);
+    if (!out)
+        return false;
+    out.write(block.data(), static_cast<std::streamsize>(block.size()));
+    return static_cast<bool>(out);
+}
+
+/**
+ * @enum ShotFormat
+ * @brief How individual shots are written (the histogram is always kept)
+ */
+enum class ShotFormat
+{
+    None,           ///< Aggregate only
+    CSV,            ///< "Shot,Measurement" text rows
+    Binary          ///< Columnar packed indices (ShotFileHeader + index column)
+};
+
+/**
+ * @struct ShotFileHeader
+ * @brief Fixed 32-byte header of a binary shot file
+ */
+struct ShotFileHeader
+{
+    char magic[8];                  ///< "QSHOTS\0\1" (format version 1)
+    uint32_t byteOrder;             ///< 0x01020304 as written by the host
+    int32_t qubits;                 ///< Register size n
+    uint32_t shotBytes;             ///< Bytes per stored index: 1, 2, 4 or 8
+    uint32_t reserved;              ///< Zero
+    uint64_t shots;                 ///< Number of shots in the column (patched on Close)
+};
+
+static_assert(sizeof(ShotFileHeader) == 32, "Shot file header must stay 32 bytes");
+
+/**
+ * @class MeasurementSink
+ * @brief Collects measurement shots as packed integers and exports them in batches
+ *
+ * Not thread-safe; give each thread its own sink and Merge() them, or record
+ * from one thread. Destruction (or Close()) drains the buffer and finalises
+ * the shot file.
+ */
+class MeasurementSink
+{
+public:
+    /**
+     * @brief Create a sink for an n-qubit register
+     * @param n Number of qubits of the measured register
+     * @param format Raw shot output format (None = histogram only)
+     * @param shotFile Path of the raw shot file (ignored for ShotFormat::None)
+     * @param capacity Shots buffered per batch
+     *
+     * Check Good() after construction when writing a shot file.
+     */
+    explicit MeasurementSink(int n, ShotFormat format = ShotFormat::None, const std::string &shotFile = "",
+                             size_t capacity = kShotBufferCapacity)
+        : bits(n), format(format), shotBytes(PackedBytes(n))
+    {
+        assert(n >= 1 && n <= 64 && "Sink registers span 1 to 64 qubits");
+        assert(capacity > 0);
+        buffer.reserve(capacity);
+        if (n <= kDenseHistogramQubits)
+            dense.assign(size_t(1) << n, 0);
+
+        if (format == ShotFormat::CSV)
+        {
+            file.open(shotFile);
+            file << "Shot,Measurement\n";
+        }
+        else if (format == ShotFormat::Binary)
+        {
+            file.open(shotFile, std::ios::binary | std::ios::trunc);
+            ShotFileHeader header = Header();
+            file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        }
+        fileOk = format == ShotFormat::None || static_cast<bool>(file);
+    }
+
+    MeasurementSink(const MeasurementSink &) = delete;
+    MeasurementSink &operator=(const MeasurementSink &) = delete;
+
+    ~MeasurementSink()
+    {
+        Close();
+    }
+
+    /**
+     * @brief Record one shot
+     * @param index Measured basis index (0 to 2^n - 1)
+     *
+     * @complexity Amortised O(1); no allocation, no formatting
+     */
+    void Record(uint64_t index)
+    {
+        assert((bits == 64 || index < (uint64_t(1) << bits)) && "Index out of range for the register");
+        buffer.push_back(index);                            // Capacity reserved: never reallocates
+        if (buffer.size() == buffer.capacity())
+            Flush();
+    }
+
+    /**
+     * @brief Record one shot given as a bitstring (MSB first, as Collapse() returns)
+     */
+    void Record(const std::string &bitstring)
+    {
+        assert(static_cast<int>(bitstring.size()) == bits);
+        Record(std::stoull(bitstring, nullptr, 2));
+    }
+
+    /**
+     * @brief Callable form of Record(), so a sink can be passed to SampleEach directly
+     */
+    void operator()(uint64_t index)
+    {
+        Record(index);
+    }
+
+    /**
+     * @brief Drain the buffered shots: count them and write them to the shot file
+     *
+     * Called automatically whenever the buffer fills, and by Close().
+     */
+    void Flush()
+    {
+        if (buffer.empty())
+            return;
+        Aggregate();
+        if (format == ShotFormat::CSV)
+            WriteCSVBatch();
+        else if (format == ShotFormat::Binary)
+            WriteBinaryBatch();
+        totalShots += buffer.size();
+        buffer.clear();
+    }
+
+    /**
+     * @brief Flush, then finalise and close the shot file (idempotent)
+     * @return true if every shot was written successfully (or no file was requested)
+     */
+    bool Close()
+    {
+        Flush();
+        if (!file.is_open())
+            return fileOk;
+        if (format == ShotFormat::Binary)
+        {
+            ShotFileHeader header = Header();               // Patch in the final shot count
+            file.seekp(0);
+            file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        }
+        file.flush();
+        fileOk = static_cast<bool>(file);
+        file.close();
+        return fileOk;
+    }
+
+    /**
+     * @brief Whether the shot file (if any) is open and writable so far
+     */
+    bool Good() const
+    {
+        return file.is_open() ? static_cast<bool>(file) : fileOk;
+    }
+
+    /**
+     * @brief Total shots recorded, including those still buffered
+     */
+    uint64_t Shots() const
+    {
+        return totalShots + buffer.size() + mergedShots;
+    }
+
+    /**
+     * @brief Aggregated histogram of every shot recorded so far
+     * @return Basis index → count, ascending (same shape as Register::Sample)
+     */
+    std::map<uint64_t, size_t> Counts()
+    {
+        Flush();
+        std::map<uint64_t, size_t> histogram;
+        if (!dense.empty())
+        {
+            for (uint64_t i = 0; i < dense.size(); ++i)
+            {
+                if (dense[i])
+                    histogram.emplace_hint(histogram.end(), i, dense[i]);
+            }
+        }
+        else
+        {
+            for (const auto &[index, count] : sparse)
+                histogram.emplace(index, count);
+        }
+        return histogram;
+    }
+
+    /**
+     * @brief Add another sink's histogram (e.g. one per thread) into this one
+     * @param other Sink for a register of the same size
+     *
+     * Only counts are merged; the other sink's raw shots stay in its own file.
+     */
+    void Merge(MeasurementSink &other)
+    {
+        assert(other.bits == bits && "Sinks measure registers of different sizes");
+        for (const auto &[index, count] : other.Counts())
+            AddCount(index, count);
+        mergedShots += other.Shots();
+    }
+
+    /**
+     * @brief Write the aggregated histogram as CSV for plotter.py
+     * @param filename Output path (e.g., "collapse_measurements.csv")
+     * @return true if the file was written successfully
+     *
+     * Output Format:
+     * Measurement,Count
+     * 000,4
+     * 001,19
+     * ...
+     * Only observed basis states are written, in ascending index order.
+     */
+    bool WriteHistogramCSV(const std::string &filename)
+    {
+        return ::WriteHistogramCSV(Counts(), bits, filename);
+    }
+
+private:
+    int bits;                                       ///< Register size n
+    ShotFormat format;                              ///< Raw shot output
+    uint32_t shotBytes;                             ///< Bytes per index in binary files
+    std::vector<uint64_t> buffer;                   ///< Pending shots (fixed capacity)
+    std::vector<uint64_t> dense;                    ///< Counts per index for n ≤ kDenseHistogramQubits
+    std::unordered_map<uint64_t, uint64_t> sparse;  ///< Counts for larger registers
+    std::ofstream file;                             ///< Raw shot output, if requested
+    std::vector<char> scratch;                      ///< Reused batch formatting block
+    uint64_t totalShots = 0;                        ///< Shots recorded here and already drained
+    uint64_t mergedShots = 0;                       ///< Shots counted in from other sinks
+    bool fileOk = true;                             ///< Final state of the closed shot file
+
+    /**
+     * @brief Smallest of 1, 2, 4, 8 bytes holding an n-bit index
+     */
+    static uint32_t PackedBytes(int n)
+    {
+        return n <= 8 ? 1 : n <= 16 ? 2 : n <= 32 ? 4 : 8;
+    }
+
+    ShotFileHeader Header() const
+    {
+        ShotFileHeader header{};
+        std::memcpy(header.magic, "QSHOTS\0\1", 8);
+        header.byteOrder = 0x01020304;
+        header.qubits = bits;
+        header.shotBytes = shotBytes;
+        header.shots = totalShots + buffer.size();
+        return header;
+    }
+
+    void AddCount(uint64_t index, uint64_t count)
+    {
+        if (!dense.empty())
+            dense[index] += count;
+        else
+            sparse[index] += count;
+    }
+
+    /**
+     * @brief Count the buffered batch into the histogram
+     */
+    void Aggregate()
+    {
+        if (!dense.empty())
+        {
+            uint64_t *counts = dense.data();
+            for (uint64_t index : buffer)
+                ++counts[index];
+        }
+        else
+        {
+            for (uint64_t index : buffer)
+                ++sparse[index];
+        }
+    }
+
+    /**
+     * @brief Append index as n characters '0'/'1', MSB first
+     */
+    void AppendBitstring(std::string &out, uint64_t index) const
+    {
+        for (int j = bits - 1; j >= 0; --j)
+            out += char('0' + ((index >> j) & 1));
+    }
+
+    /**
+     * @brief Format the batch as "shot,bits\n" rows into one block and write it
+     *
+     * Rows are formatted with plain character arithmetic into a reused
+     * buffer: no std::to_string, no per-row stream insertion.
+     */
+    void WriteCSVBatch()
+    {
+        scratch.resize(buffer.size() * (21 + bits + 2));    // ≤ 20 digits + ',' + n bits + '\n'
+        char *out = scratch.data();
+        uint64_t shot = totalShots;
+        for (uint64_t index : buffer)
+        {
+            char digits[20];
+            int d = 0;
+            uint64_t k = ++shot;                            // Shots numbered from 1, like coin_flips.csv
+            do
+            {
+                digits[d++] = char('0' + k % 10);
+                k /= 10;
+            } while (k);
+            while (d)
+                *out++ = digits[--d];
+            *out++ = ',';
+            for (int j = bits - 1; j >= 0; --j)
+                *out++ = char('0' + ((index >> j) & 1));
+            *out++ = '\n';
+        }
+        file.write(scratch.data(), out - scratch.data());
+    }
+
+    /**
+     * @brief Narrow the batch to shotBytes per index and append it to the column
+     */
+    void WriteBinaryBatch()
+    {
+        if (shotBytes == sizeof(uint64_t))
+        {
+            file.write(reinterpret_cast<const char *>(buffer.data()),
+                       static_cast<std::streamsize>(buffer.size() * sizeof(uint64_t)));
+            return;
+        }
+        scratch.resize(buffer.size() * shotBytes);
+        char *out = scratch.data();
+        for (uint64_t index : buffer)
+        {
+            switch (shotBytes)
+            {
+            case 1: { uint8_t v = uint8_t(index); std::memcpy(out, &v, 1); break; }
+            case 2: { uint16_t v = uint16_t(index); std::memcpy(out, &v, 2); break; }
+            default: { uint32_t v = uint32_t(index); std::memcpy(out, &v, 4); break; }
+            }
+            out += shotBytes;
+        }
+        file.write(scratch.data(), static_cast<std::streamsize>(scratch.size()));
+    }
+};
+
+/**
+ * @brief Draw shots from a register straight into a sink
+ * @param reg Register to sample (not modified)
+ * @param shots Number of shots
+ * @param sink Destination sink (sized for reg.bits qubits)
+ *
+ * Uses the register's own engine, like Sample(shots).
+ *
+ * @complexity Time: O(2^n + shots·n), Space: O(2^n) for the cumulative array
+ */
+template <typename T>
+void RecordSamples(BasicRegister<T> &reg, size_t shots, MeasurementSink &sink)
+{
+    reg.SampleEach(shots, reg.Engine(), sink);
+}
+
+#endif // MEASUREMENT_SINK_CL_CPP
@@ -0,0 +1,383 @@
+/**
+ * @file NoiseModel_cl.cpp
+ * @brief Noisy circuit simulation by Monte-Carlo (quantum) trajectories
+ *
+ * Until now every simulated state was pure and every gate ideal. Noise in a
+ * density-matrix picture needs 4^n numbers. A trajectory simulation keeps
+ * the 2^n pure state and instead applies each noise channel
+ * E(ρ) = Σₖ Kₖ ρ Kₖ† by randomly choosing one Kraus operator per channel
+ * application, with its Born probability:
+ *
+ *     p_k = ‖Kₖ|ψ⟩‖²,   |ψ⟩ → Kₖ|ψ⟩ / √p_k
+ *
+ * Averaged over many independent trajectories, the measurement statistics
+ * converge to those of the density matrix.
+ *
+ * Channels (one qubit, applied after a gate to each qubit it acts on):
+ * - BitFlip(p):          X with probability p
+ * - Depolarizing(p):     X, Y or Z, each with probability p/3
+ *                        (ρ → (1-p)ρ + p/3·(XρX + YρY + ZρZ))
+ * - AmplitudeDamping(γ): |1⟩ decays to |0⟩. Jump probability γ·P(q = 1),
+ *                        K₀ = diag(1, √(1-γ)), K₁ = √γ·|0⟩⟨1|
+ * The Pauli channels are unitary mixtures, with probabilities independent
+ * of the state. Damping needs one ⟨Z_q⟩ pass to weigh its branches.
+ *
+ * A NoiseModel attaches channels to gate names (RGates::Name(): "H",
+ * "CNOT", ...) or to every gate. NoisyCircuit records RGates like Circuit
+ * does and inserts the model's channels after each matching gate. The
+ * noise-free stretches between channels are compiled (and fused) once into
+ * CompiledCircuits:
+ *
+ * NoiseModel model;
+ * model.AfterEveryGate(NoiseChannel::Depolarizing, 0.001)
+ *      .AfterGate("CNOT", NoiseChannel::Depolarizing, 0.01);
+ * NoisyCircuit bell(2, model);
+ * bell.Gate(HadamardR(), 1).Gate(CNotGateR(1), 0);
+ * auto counts = bell.Run(Register(2), 10000);     // 10000 trajectories, one shot each
+ *
+ * Run() executes trajectories in parallel on the ThreadPool, one trajectory
+ * per worker at a time. Each trajectory is serial inside its worker.
+ * - Every work chunk owns one state buffer, reused by all its trajectories.
+ *   Concurrent memory is about ThreadCount() + 1 state vectors.
+ * - Trajectory t draws from its own stream Xoshiro256(seed, t), and
+ *   per-chunk histograms are merged in order, so results do not depend on
+ *   the thread count.
+ * - When the concurrent buffers would exceed the memory budget, or there
+ *   is only one trajectory, trajectories run one after another with
+ *   parallel gate kernels instead.
+ *
+ * @author Your Name
+ * @date 2025
+ */
+
+#ifndef NOISE_MODEL_CL_CPP
+#define NOISE_MODEL_CL_CPP
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Circuit_cl.cpp"
+
+/**
+ * @enum NoiseChannel
+ * @brief Single-qubit noise channels available to trajectories
+ */
+enum class NoiseChannel
+{
+    BitFlip,            ///< X with probability p
+    Depolarizing,       ///< X, Y or Z, each with probability p/3
+    AmplitudeDamping    ///< Energy relaxation |1⟩ → |0⟩ with rate γ = p
+};
+
+/**
+ * @struct NoiseOp
+ * @brief One channel with its strength
+ */
+struct NoiseOp
+{
+    NoiseChannel channel;
+    double probability;     ///< p (or γ for AmplitudeDamping), in [0, 1]
+};
+
+/**
+ * @class NoiseModel
+ * @brief Channels attached to gates by name, applied after each matching gate
+ */
+class NoiseModel
+{
+public:
+    /**
+     * @brief Apply a channel after every recorded gate
+     */
+    NoiseModel &AfterEveryGate(NoiseChannel channel, double probability)
+    {
+        assert(probability >= 0.0 && probability <= 1.0 && "Channel probability must be in [0, 1]");
+        everyGate.push_back({channel, probability});
+        return *this;
+    }
+
+    /**
+     * @brief Apply a channel after every gate called gateName (RGates::Name(), e.g. "H", "CNOT")
+     */
+    NoiseModel &AfterGate(const std::string &gateName, NoiseChannel channel, double probability)
+    {
+        assert(probability >= 0.0 && probability <= 1.0 && "Channel probability must be in [0, 1]");
+        byGate[gateName].push_back({channel, probability});
+        return *this;
+    }
+
+    /**
+     * @brief Channels following a gate: the every-gate channels, then the gate's own
+     */
+    std::vector<NoiseOp> For(const std::string &gateName) const
+    {
+        std::vector<NoiseOp> ops = everyGate;
+        auto it = byGate.find(gateName);
+        if (it != byGate.end())
+            ops.insert(ops.end(), it->second.begin(), it->second.end());
+        return ops;
+    }
+
+private:
+    std::vector<NoiseOp> everyGate;
+    std::map<std::string, std::vector<NoiseOp>> byGate;
+};
+
+/**
+ * @class NoisyCircuit
+ * @brief Circuit whose gates are followed by the noise model's channels, run as trajectories
+ */
+class NoisyCircuit
+{
+public:
+    NoisyCircuit(int n, NoiseModel noise) : bits(n), model(std::move(noise)), unitary(n) {}
+
+    /**
+     * @brief Record a fixed single-qubit register gate (H, X, Y, Z, S, T, MatrixGateR)
+     */
+    NoisyCircuit &Gate(const RGates &gate, int q)
+    {
+        unitary.Gate(gate, q);
+        AddNoise(gate.Name(), uint64_t(1) << q);
+        return *this;
+    }
+
+    /**
+     * @brief Record a controlled register gate (CNOT, CZ, Toffoli, ControlledGateR)
+     * @param target Target qubit; noise follows on the target and every control
+     */
+    NoisyCircuit &Gate(const ControlledGateR &gate, int target)
+    {
+        std::vector<int> controls;
+        for (int c = 0; c < bits; ++c)
+        {
+            if ((gate.ControlMask() >> c) & 1)
+                controls.push_back(c);
+        }
+        unitary.Controlled(gate.TargetMatrix(), target, controls);
+        AddNoise(gate.Name(), gate.ControlMask() | (uint64_t(1) << target));
+        return *this;
+    }
+
+    /**
+     * @brief Insert a channel explicitly (e.g. idle noise between layers)
+     */
+    NoisyCircuit &Noise(NoiseChannel channel, double probability, int q)
+    {
+        assert(q >= 0 && q < bits && "Qubit index out of range");
+        assert(probability >= 0.0 && probability <= 1.0 && "Channel probability must be in [0, 1]");
+        FlushUnitary();
+        if (probability > 0.0)
+            segments.back().noise.push_back({q, {channel, probability}});
+        return *this;
+    }
+
+    /**
+     * @brief Evolve one trajectory in place
+     * @param reg State to evolve; ends normalised
+     * @param engine Draws the Kraus branches
+     */
+    template <typename T>
+    void RunTrajectory(BasicRegister<T> &reg, Xoshiro256 &engine) const
+    {
+        assert(reg.bits >= bits && "Register too small for circuit");
+        for (const Segment &segment : Program())
+        {
+            segment.unitary.Execute(reg);
+            for (const Channel &c : segment.noise)
+                ApplyChannel(reg, c.qubit, c.op, engine);
+        }
+    }
+
+    /**
+     * @brief Run independent trajectories and return the merged measurement histogram
+     * @param initial Starting state (copied into every trajectory, not modified)
+     * @param trajectories Number of trajectories
+     * @param shotsPerTrajectory Samples drawn from each trajectory's final state
+     * @param seed Trajectory t uses stream Xoshiro256(seed, t)
+     * @return Basis index → count over trajectories × shotsPerTrajectory shots
+     *
+     * One shot per trajectory samples the noisy distribution exactly. More
+     * shots per trajectory amortise the simulation at the price of correlated
+     * samples.
+     *
+     * @complexity Time: O(trajectories × gates × 2^n / threads),
+     *             Space: O(min(threads, trajectories) × 2^n)
+     */
+    template <typename T>
+    std::map<uint64_t, size_t> Run(const BasicRegister<T> &initial, size_t trajectories,
+                                   size_t shotsPerTrajectory = 1, uint64_t seed = 0) const
+    {
+        Program();                                              // Compile once, before the workers start
+        ThreadPool &pool = ThreadPool::Instance();
+        const uint64_t threads = pool.ThreadCount();
+        const uint64_t budget = RegisterBudget::MemoryBudget();
+        const uint64_t stateBytes = RegisterBudget::StateBytes(initial.bits, sizeof(COMPLEX<T>));
+        const bool perWorker = trajectories > 1 && threads > 1 &&
+                               (budget == 0 || stateBytes <= budget / (threads + 1));
+
+        // Chunks are a few per thread (balance) and fixed given the count (determinism)
+        const uint64_t chunk = perWorker ? std::max<uint64_t>(1, trajectories / (4 * threads)) : trajectories;
+        const uint64_t chunks = trajectories ? (trajectories + chunk - 1) / chunk : 0;
+        std::vector<std::map<uint64_t, size_t>> partial(chunks);
+        auto runChunk = [&](uint64_t c) {
+            BasicRegister<T> reg(initial);                      // This chunk's buffer
+            const uint64_t end = std::min<uint64_t>((c + 1) * chunk, trajectories);
+            for (uint64_t t = c * chunk; t < end; ++t)
+            {
+                Xoshiro256 engine(seed, t);
+                if (t != c * chunk)
+                    reg.CopyStateFrom(initial);
+                RunTrajectory(reg, engine);
+                reg.SampleEach(shotsPerTrajectory, engine, [&](uint64_t index) { ++partial[c][index]; });
+            }
+        };
+        if (perWorker)
+        {
+            pool.ParallelFor(chunks, 1, [&](uint64_t first, uint64_t last) {
+                for (uint64_t c = first; c < last; ++c)
+                    runChunk(c);
+            });
+        }
+        else
+        {
+            for (uint64_t c = 0; c < chunks; ++c)
+                runChunk(c);
+        }
+
+        std::map<uint64_t, size_t> histogram;
+        for (const auto &counts : partial)
+        {
+            for (const auto &[index, count] : counts)
+                histogram[index] += count;
+        }
+        return histogram;
+    }
+
+    /**
+     * @brief Number of channel applications per trajectory
+     */
+    size_t ChannelCount() const
+    {
+        size_t count = 0;
+        for (const Segment &segment : Program())
+            count += segment.noise.size();
+        return count;
+    }
+
+private:
+    struct Channel
+    {
+        int qubit;
+        NoiseOp op;
+    };
+
+    /// Noise-free stretch (compiled once) followed by the channels that end it
+    struct Segment
+    {
+        CompiledCircuit unitary;
+        std::vector<Channel> noise;
+    };
+
+    int bits;
+    NoiseModel model;
+    Circuit unitary;                        ///< Gates since the last channel
+    std::vector<Segment> segments;          ///< Closed segments
+    mutable std::vector<Segment> program;   ///< segments + the compiled tail
+    mutable bool compiled = false;
+
+    void AddNoise(const char *gateName, uint64_t qubits)
+    {
+        compiled = false;
+        const std::vector<NoiseOp> ops = model.For(gateName);
+        bool any = false;
+        for (const NoiseOp &op : ops)
+            any = any || op.probability > 0.0;
+        if (!any)
+            return;
+        FlushUnitary();
+        for (int q = 0; q < bits; ++q)
+        {
+            if (!((qubits >> q) & 1))
+                continue;
+            for (const NoiseOp &op : ops)
+            {
+                if (op.probability > 0.0)
+                    segments.back().noise.push_back({q, op});
+            }
+        }
+    }
+
+    /**
+     * @brief Close the current noise-free stretch into its own segment
+     */
+    void FlushUnitary()
+    {
+        compiled = false;
+        segments.push_back({unitary.Compile(), {}});
+        unitary = Circuit(bits);
+    }
+
+    const std::vector<Segment> &Program() const
+    {
+        if (!compiled)
+        {
+            program = segments;
+            if (unitary.Size() > 0)
+                program.push_back({unitary.Compile(), {}});
+            compiled = true;
+        }
+        return program;
+    }
+
+    /**
+     * @brief Apply one branch of a channel to qubit q, drawn with its Born probability
+     */
+    template <typename T>
+    static void ApplyChannel(BasicRegister<T> &reg, int q, const NoiseOp &op, Xoshiro256 &engine)
+    {
+        const double r = engine.UniformDouble();
+        switch (op.channel)
+        {
+        case NoiseChannel::BitFlip:
+            if (r < op.probability)
+                XGateR().ApplyToSingle(reg, q);
+            break;
+        case NoiseChannel::Depolarizing:
+            if (r < op.probability)
+            {
+                const int pauli = std::min(2, static_cast<int>(3.0 * r / op.probability));
+                if (pauli == 0)
+                    XGateR().ApplyToSingle(reg, q);
+                else if (pauli == 1)
+                    YGateR().ApplyToSingle(reg, q);
+                else
+                    ZGateR().ApplyToSingle(reg, q);
+            }
+            break;
+        case NoiseChannel::AmplitudeDamping:
+        {
+            const double gamma = op.probability;
+            const double one = 0.5 * (1.0 - reg.ExpectationZ(uint64_t(1) << q));    // P(q = 1)
+            const double jump = gamma * one;
+            if (r < jump)                                   // K₁/√p: |1⟩ → |0⟩, |0⟩ → 0
+                ApplyMatrix2(reg, q, Matrix2{{0.0, 1.0 / std::sqrt(one), 0.0, 0.0}});
+            else                                            // K₀/√p: damp the |1⟩ half
+            {
+                const double s = 1.0 / std::sqrt(1.0 - jump);
+                ApplyMatrix2(reg, q, Matrix2{{s, 0.0, 0.0, std::sqrt(1.0 - gamma) * s}});
+            }
+            reg.MarkDirty();                                // Kraus update: norm restored only up to rounding
+            break;
+        }
+        }
+    }
+};
+
+#endif // NOISE_MODEL_CL_CPP
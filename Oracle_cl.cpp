@@ -0,0 +1,301 @@
+/**
+ * @file Oracle_cl.cpp
+ * @brief n-input Boolean oracles for Deutsch–Jozsa and Bernstein–Vazirani
+ *
+ * DeutschOracle (DeutscheAlgo_example.cpp) covers the four functions of one
+ * input bit. BooleanOracle generalises it to f: {0,1}^n → {0,1} given as
+ *
+ * - a truth table (2^n entries, stored bit-packed: 64 inputs per word),
+ * - any callable bool(uint64_t) (evaluated once into the table), or
+ * - a linear function f(x) = s·x ⊕ b (Bernstein–Vazirani), evaluated as the
+ *   parity of x & s without a table.
+ *
+ * Two ways to apply it:
+ *
+ * 1. Bit oracle (ApplyBit), the textbook form on n + 1 qubits:
+ *        U_f |x⟩|y⟩ = |x⟩|y ⊕ f(x)⟩
+ *    with the ancilla y on qubit 0 and x on qubits 1..n (as in Deutsch's
+ *    example); every pair (|x⟩|0⟩, |x⟩|1⟩) with f(x) = 1 is swapped.
+ *
+ * 2. Phase oracle (ApplyPhase), on just the n input qubits:
+ *        P_f |x⟩ = (-1)^f(x) |x⟩
+ *    This is what the bit oracle does to |x⟩|−⟩ (phase kickback), with the
+ *    ancilla folded away: half the state-vector memory, and the swaps become
+ *    one sign pass — each amplitude is multiplied by 1 - 2·f(x), a ±1 factor
+ *    computed branch-free from the packed table word so the loop vectorises.
+ *
+ * Usage:
+ * BooleanOracle f = BooleanOracle::FromFunction(10, [](uint64_t x) { return (x & 1) != 0; });
+ * DeutschJozsaResult r = RunDeutschJozsa<double>(f);       // r.constant == false
+ * uint64_t s = RunBernsteinVazirani<double>(BooleanOracle::Linear(20, 0xBEEF));  // s == 0xBEEF
+ *
+ * @author Your Name
+ * @date 2025
+ */
+
+#ifndef ORACLE_CL_CPP
+#define ORACLE_CL_CPP
+
+#include <bitset>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "RegisterGates_cl.cpp"
+
+/**
+ * @class BooleanOracle
+ * @brief Classical function f: {0,1}^n → {0,1} applied as a bit or phase oracle
+ */
+class BooleanOracle
+{
+public:
+    /**
+     * @brief Oracle from an explicit truth table
+     * @param n Number of input bits
+     * @param truthTable 2^n values, truthTable[x] = f(x)
+     */
+    static BooleanOracle FromTruthTable(int n, const std::vector<bool> &truthTable)
+    {
+        assert(truthTable.size() == (uint64_t(1) << n) && "Truth table needs 2^n entries");
+        BooleanOracle oracle(n);
+        for (uint64_t x = 0; x < truthTable.size(); ++x)
+        {
+            if (truthTable[x])
+                oracle.table[x >> 6] |= uint64_t(1) << (x & 63);
+        }
+        return oracle;
+    }
+
+    /**
+     * @brief Oracle from a callable, evaluated once for every input
+     * @param n Number of input bits
+     * @param f Callable bool(uint64_t x)
+     */
+    template <typename F>
+    static BooleanOracle FromFunction(int n, F &&f)
+    {
+        BooleanOracle oracle(n);
+        for (uint64_t x = 0; x < (uint64_t(1) << n); ++x)
+        {
+            if (f(x))
+                oracle.table[x >> 6] |= uint64_t(1) << (x & 63);
+        }
+        return oracle;
+    }
+
+    /**
+     * @brief Constant oracle f(x) = value
+     */
+    static BooleanOracle Constant(int n, bool value)
+    {
+        return Linear(n, 0, value);
+    }
+
+    /**
+     * @brief Linear oracle f(x) = popcount(x & secret) mod 2 ⊕ bias (Bernstein–Vazirani)
+     *
+     * Stored analytically (no 2^n table); secret = 0 gives a constant and any
+     * other secret a balanced function.
+     */
+    static BooleanOracle Linear(int n, uint64_t secret, bool bias = false)
+    {
+        assert(n >= 1 && n <= 63 && (n == 63 || (secret >> n) == 0) && "Secret must fit in n bits");
+        BooleanOracle oracle(n, /*withTable=*/false);
+        oracle.secret = secret;
+        oracle.bias = bias;
+        return oracle;
+    }
+
+    /**
+     * @brief Number of input bits n
+     */
+    int Inputs() const
+    {
+        return inputs;
+    }
+
+    /**
+     * @brief Classical evaluation f(x)
+     */
+    bool Evaluate(uint64_t x) const
+    {
+        if (table.empty())
+            return ((std::bitset<64>(x & secret).count() & 1) != 0) != bias;
+        return (table[x >> 6] >> (x & 63)) & 1;
+    }
+
+    /**
+     * @brief Phase oracle |x⟩ → (-1)^f(x) |x⟩ on qubits 0..n-1
+     * @param reg Register whose low n qubits hold x (wider registers: higher qubits are spectators)
+     *
+     * One parallel pass multiplying each amplitude by 1 - 2·f(x). Table
+     * oracles read one packed word per 64 amplitudes; linear oracles use
+     * the parity of x & s.
+     *
+     * @complexity Time: O(2^n), Space: O(1)
+     */
+    template <typename T>
+    void ApplyPhase(BasicRegister<T> &reg) const
+    {
+        assert(reg.bits >= inputs && "Register has fewer qubits than the oracle inputs");
+        COMPLEX<T> *amp = reg.val.data();
+        const uint64_t inputMask = (uint64_t(1) << inputs) - 1;
+        const BooleanOracle *self = this;
+        ThreadPool::Instance().ParallelFor(reg.val.size(), kAmplitudesPerReduceChunk, [=](uint64_t begin, uint64_t end) {
+            if (self->table.empty())
+            {
+                for (uint64_t i = begin; i < end; ++i)
+                {
+                    const T sign = self->Evaluate(i & inputMask) ? T(-1) : T(1);
+                    amp[i] *= sign;
+                }
+                return;
+            }
+            const uint64_t *words = self->table.data();
+            uint64_t i = begin;
+            if (inputMask >= 63)
+            {
+                for (; i + 64 <= end; i += 64)              // Chunks start on multiples of 64
+                {
+                    const uint64_t word = words[(i & inputMask) >> 6];
+                    T *p = reinterpret_cast<T *>(amp + i);
+                    for (int j = 0; j < 64; ++j)
+                    {
+                        const T sign = T(1) - T(2) * T((word >> j) & 1);
+                        p[2 * j] *= sign;
+                        p[2 * j + 1] *= sign;
+                    }
+                }
+            }
+            for (; i < end; ++i)
+            {
+                const T sign = self->Evaluate(i & inputMask) ? T(-1) : T(1);
+                amp[i] *= sign;
+            }
+        });
+        reg.MarkDirty(true);
+    }
+
+    /**
+     * @brief Bit oracle |x⟩|y⟩ → |x⟩|y ⊕ f(x)⟩ with y on qubit 0 and x on qubits 1..n
+     * @param reg Register with at least n + 1 qubits (higher qubits are spectators)
+     *
+     * @complexity Time: O(2^n), Space: O(1)
+     */
+    template <typename T>
+    void ApplyBit(BasicRegister<T> &reg) const
+    {
+        assert(reg.bits >= inputs + 1 && "Bit oracle needs n input qubits plus an ancilla");
+        COMPLEX<T> *amp = reg.val.data();
+        const uint64_t inputMask = (uint64_t(1) << inputs) - 1;
+        const BooleanOracle *self = this;
+        ThreadPool::Instance().ParallelFor(reg.val.size() / 2, kPairsPerChunk, [=](uint64_t begin, uint64_t end) {
+            for (uint64_t k = begin; k < end; ++k)
+            {
+                if (self->Evaluate(k & inputMask))
+                    std::swap(amp[2 * k], amp[2 * k + 1]);  // y ↔ y ⊕ 1 for this x
+            }
+        });
+        reg.MarkDirty(true);
+    }
+
+    /**
+     * @brief Number of inputs with f(x) = 1 (classical check, e.g. for promises)
+     */
+    uint64_t CountOnes() const
+    {
+        if (table.empty())
+            return secret ? (uint64_t(1) << (inputs - 1)) : (bias ? uint64_t(1) << inputs : 0);
+        uint64_t ones = 0;
+        for (uint64_t word : table)
+            ones += std::bitset<64>(word).count();
+        return ones;
+    }
+
+private:
+    int inputs;                             ///< Number of input bits n
+    std::vector<uint64_t> table;            ///< Packed truth table (empty for linear oracles)
+    uint64_t secret = 0;                    ///< Linear oracles: f(x) = s·x ⊕ b
+    bool bias = false;
+
+    explicit BooleanOracle(int n, bool withTable = true) : inputs(n)
+    {
+        assert(n >= 1 && n <= 63 && "Oracles take 1 to 63 input bits");
+        if (withTable)
+        {
+            RegisterBudget::CheckMemoryBudget(n, 1);                // 2^n bits ≤ 2^n bytes
+            table.assign(std::max<uint64_t>(1, (uint64_t(1) << n) / 64), 0);
+        }
+    }
+};
+
+/**
+ * @struct DeutschJozsaResult
+ * @brief Outcome of one Deutsch–Jozsa run
+ */
+struct DeutschJozsaResult
+{
+    bool constant;                          ///< True if the input register measured |0...0⟩
+    uint64_t measured;                      ///< Measured input bits
+    double probabilityZero;                 ///< P(0...0) = |Σₓ (-1)^f(x)|² / 4^n
+};
+
+/**
+ * @brief Run Deutsch–Jozsa: decide constant vs balanced with one oracle query
+ * @tparam T Register precision
+ * @param oracle Function promised to be constant or balanced
+ * @param phaseOracle Use the ancilla-free phase oracle (n qubits) instead of the bit oracle (n + 1)
+ * @param seed Measurement seed
+ *
+ * Circuit (phase form): |0⟩^n → H^⊗n → P_f → H^⊗n → measure.
+ * The amplitude of |0...0⟩ is Σₓ (-1)^f(x) / 2^n: ±1 for a constant f and 0
+ * for a balanced one, so the measurement is deterministic.
+ * The bit form prepares the ancilla (qubit 0) in |1⟩ and applies H to it too.
+ */
+template <typename T>
+DeutschJozsaResult RunDeutschJozsa(const BooleanOracle &oracle, bool phaseOracle = true, uint64_t seed = 0)
+{
+    const int n = oracle.Inputs();
+    const HadamardR H;
+    DeutschJozsaResult result{};
+    if (phaseOracle)
+    {
+        BasicRegister<T> reg(n);
+        reg.Seed(seed);
+        H.Apply(reg);
+        oracle.ApplyPhase(reg);
+        H.Apply(reg);
+        result.probabilityZero = reg.GetProbab(0);
+        result.measured = reg.MeasureIndex();
+    }
+    else
+    {
+        BasicRegister<T> reg(n + 1);
+        reg.Seed(seed);
+        XGateR().ApplyToSingle(reg, 0);                     // Ancilla |1⟩
+        H.Apply(reg);                                       // Inputs |+⟩^n, ancilla |−⟩
+        oracle.ApplyBit(reg);
+        for (int q = 1; q <= n; ++q)
+            H.ApplyToSingle(reg, q);
+        result.probabilityZero = reg.MarginalProbabilities(((uint64_t(1) << n) - 1) << 1)[0];
+        result.measured = reg.Measure(((uint64_t(1) << n) - 1) << 1) >> 1;
+    }
+    result.constant = result.measured == 0;
+    return result;
+}
+
+/**
+ * @brief Run Bernstein–Vazirani: recover s from f(x) = s·x ⊕ b with one query
+ * @return The measured input bits, equal to s with probability 1
+ *
+ * Same circuit as Deutsch–Jozsa (phase oracle): H^⊗n P_f H^⊗n |0⟩ = ±|s⟩.
+ */
+template <typename T>
+uint64_t RunBernsteinVazirani(const BooleanOracle &oracle, uint64_t seed = 0)
+{
+    return RunDeutschJozsa<T>(oracle, true, seed).measured;
+}
+
+#endif // ORACLE_CL_CPP
@@ -0,0 +1,319 @@
+/**
+ * @file Parallel_cl.cpp
+ * @brief Minimal persistent thread pool for parallel state-vector sweeps
+ *
+ * Register gate kernels touch every amplitude pair of a 2^n state vector. On
+ * large registers (n ≳ 20) a single core cannot saturate memory bandwidth, so
+ * the kernels hand their pair range to ParallelFor(), which splits it into
+ * cache-sized chunks and lets a fixed set of worker threads pull chunks until
+ * the range is exhausted.
+ *
+ * Design:
+ * - Workers are created once and park on a condition variable between jobs
+ *   (no thread creation per gate)
+ * - Work is distributed dynamically through an atomic chunk counter, so
+ *   uneven chunks or busy cores do not stall the whole sweep
+ * - The calling thread participates as one of the workers
+ * - Small ranges (a single chunk) run inline on the caller with no
+ *   synchronisation at all
+ * - An exception thrown by a chunk (on a worker or on the caller) stops the
+ *   remaining chunks; ParallelFor waits for the workers and rethrows the
+ *   first one on the calling thread
+ *
+ * Thread Count:
+ * Defaults to std::thread::hardware_concurrency(). Override with
+ * ThreadPool::Instance().SetThreadCount(n); n = 1 gives fully serial execution.
+ *
+ * @author Your Name
+ * @date 2025
+ */
+
+#ifndef PARALLEL_CL_CPP
+#define PARALLEL_CL_CPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class ThreadPool
+ * @brief Process-wide pool executing chunked parallel-for loops
+ *
+ * Example Usage:
+ * ThreadPool::Instance().ParallelFor(size / 2, kPairsPerChunk,
+ *     [&](uint64_t begin, uint64_t end) {
+ *         for (uint64_t k = begin; k < end; ++k) { ... }
+ *     });
+ */
+class ThreadPool
+{
+public:
+    /**
+     * @brief Access the shared pool used by all register kernels
+     */
+    static ThreadPool &Instance()
+    {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    /**
+     * @brief Change the number of threads used for parallel sweeps
+     * @param n Total thread count including the caller (0 → hardware concurrency)
+     *
+     * Existing workers are joined and a fresh set is started.
+     */
+    void SetThreadCount(unsigned n)
+    {
+        std::lock_guard<std::mutex> jobLock(jobMutex);
+        StopWorkers();
+        StartWorkers(n == 0 ? DefaultThreadCount() : n);
+    }
+
+    /**
+     * @brief Number of threads (including the caller) taking part in a sweep
+     */
+    unsigned ThreadCount() const
+    {
+        return workerCount.load(std::memory_order_relaxed) + 1;
+    }
+
+    /**
+     * @brief Run fn over [0, count) split into chunks of at most chunk items
+     * @param count Number of loop iterations
+     * @param chunk Iterations per work item (sized to stay cache resident)
+     * @param fn Callable invoked as fn(begin, end) for each chunk
+     *
+     * Blocks until every chunk has completed. Calls made from inside a chunk
+     * (nested parallelism, on a worker or on the caller) run serially there.
+     * 
+     * @throws Whatever fn throws first; chunks not yet claimed are skipped,
+     *         and the call returns only after every worker has left the job
+     */
+    template <typename F>
+    void ParallelFor(uint64_t count, uint64_t chunk, F &&fn)
+    {
+        chunk = std::max<uint64_t>(chunk, 1);
+        if (count <= chunk || workerCount.load(std::memory_order_relaxed) == 0 || insideWorker)
+        {
+            if (count > 0)
+                fn(uint64_t(0), count);
+            return;
+        }
+
+        std::unique_lock<std::mutex> jobLock(jobMutex);
+        if (workers.empty())                            // SetThreadCount(1) ran since the check above
+        {
+            jobLock.unlock();
+            fn(uint64_t(0), count);
+            return;
+        }
+        job = std::ref(fn);
+        jobCount = count;
+        jobChunk = chunk;
+        nextChunk.store(0, std::memory_order_relaxed);
+        failed.store(false, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            pending = static_cast<unsigned>(workers.size());
+            ++generation;
+        }
+        wake.notify_all();
+
+        std::exception_ptr failure;
+        {
+            JobScope scope(*this, failure);             // Waits for the workers however the caller leaves
+            RunChunks();
+        }
+        if (failure)
+            std::rethrow_exception(failure);
+    }
+
+    /**
+     * @brief Parallel reduction over [0, count) in chunks of at most chunk items
+     * @param count Number of loop iterations
+     * @param chunk Iterations per partial result
+     * @param init Initial value of the result
+     * @param fn Callable returning the partial result fn(begin, end) of one chunk
+     * @return init + Σ partials, combined in chunk order
+     *
+     * Partials are stored per chunk and summed serially afterwards, so the
+     * result is bit-identical for every thread count.
+     */
+    template <typename R, typename F>
+    R ParallelReduce(uint64_t count, uint64_t chunk, R init, F &&fn)
+    {
+        chunk = std::max<uint64_t>(chunk, 1);
+        const uint64_t chunks = (count + chunk - 1) / chunk;
+        if (chunks <= 1)
+        {
+            if (count > 0)
+                init += fn(uint64_t(0), count);
+            return init;
+        }
+
+        std::vector<R> partial(chunks);
+        ParallelFor(chunks, 1, [&](uint64_t first, uint64_t last) {
+            for (uint64_t c = first; c < last; ++c)
+            {
+                uint64_t begin = c * chunk;
+                partial[c] = fn(begin, std::min(begin + chunk, count));
+            }
+        });
+        for (const R &p : partial)
+            init += p;
+        return init;
+    }
+
+    ~ThreadPool()
+    {
+        StopWorkers();
+    }
+
+private:
+    std::vector<std::thread> workers;               ///< Parked worker threads (jobMutex)
+    std::atomic<unsigned> workerCount{0};           ///< workers.size(), readable without jobMutex
+    std::mutex jobMutex;                            ///< Serialises ParallelFor calls
+    std::mutex stateMutex;                          ///< Guards generation/pending/stopping
+    std::condition_variable wake;                   ///< Signals a new job
+    std::condition_variable done;                   ///< Signals all workers finished
+    std::function<void(uint64_t, uint64_t)> job;    ///< Current chunk body
+    uint64_t jobCount = 0;                          ///< Iterations in current job
+    uint64_t jobChunk = 1;                          ///< Iterations per chunk
+    std::atomic<uint64_t> nextChunk{0};             ///< Next chunk id to claim
+    std::atomic<bool> failed{false};                ///< A chunk of the current job threw
+    std::exception_ptr error;                       ///< First exception of the current job (stateMutex)
+    uint64_t generation = 0;                        ///< Incremented per job
+    unsigned pending = 0;                           ///< Workers still busy on job
+    bool stopping = false;                          ///< Shutdown flag
+
+    static inline thread_local bool insideWorker = false;
+
+    /**
+     * @brief The caller's share of a job: its nested calls run inline, and on
+     *        exit it waits for the workers, clears the job and takes its error
+     */
+    class JobScope
+    {
+    public:
+        JobScope(ThreadPool &pool, std::exception_ptr &failure) : pool(pool), failure(failure)
+        {
+            insideWorker = true;
+        }
+
+        ~JobScope()
+        {
+            insideWorker = false;
+            std::unique_lock<std::mutex> lock(pool.stateMutex);
+            pool.done.wait(lock, [this] { return pool.pending == 0; });
+            pool.job = nullptr;
+            failure = pool.error;
+            pool.error = nullptr;
+        }
+
+        JobScope(const JobScope &) = delete;
+        JobScope &operator=(const JobScope &) = delete;
+
+    private:
+        ThreadPool &pool;
+        std::exception_ptr &failure;
+    };
+
+    ThreadPool()
+    {
+        StartWorkers(DefaultThreadCount());
+    }
+
+    static unsigned DefaultThreadCount()
+    {
+        unsigned hc = std::thread::hardware_concurrency();
+        return hc == 0 ? 1 : hc;
+    }
+
+    void StartWorkers(unsigned total)
+    {
+        uint64_t current;
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            stopping = false;
+            current = generation;                   // New workers wait for the next job, not the last one
+        }
+        for (unsigned t = 1; t < total; ++t)
+        {
+            workers.emplace_back([this, current] { WorkerLoop(current); });
+        }
+        workerCount.store(static_cast<unsigned>(workers.size()), std::memory_order_relaxed);
+    }
+
+    void StopWorkers()
+    {
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto &w : workers)
+            w.join();
+        workers.clear();
+        workerCount.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Claim and execute chunks until the job range is exhausted or a chunk threw
+     *
+     * Records the first exception for ParallelFor to rethrow; never throws.
+     */
+    void RunChunks() noexcept
+    {
+        const uint64_t chunks = (jobCount + jobChunk - 1) / jobChunk;
+        try
+        {
+            for (uint64_t c = nextChunk.fetch_add(1); c < chunks && !failed.load(std::memory_order_relaxed);
+                 c = nextChunk.fetch_add(1))
+            {
+                uint64_t begin = c * jobChunk;
+                job(begin, std::min(begin + jobChunk, jobCount));
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            if (!error)
+                error = std::current_exception();
+            failed.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Worker body
+     * @param seen Job generation current when the worker was started
+     */
+    void WorkerLoop(uint64_t seen)
+    {
+        insideWorker = true;
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(stateMutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping)
+                    return;
+                seen = generation;
+            }
+
+            RunChunks();
+
+            std::lock_guard<std::mutex> lock(stateMutex);
+            if (--pending == 0)
+                done.notify_one();
+        }
+    }
+};
+
+#endif // PARALLEL_CL_CPP
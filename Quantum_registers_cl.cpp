@@ -23,6 +23,9 @@
  * @date 2025
  */
 
+#ifndef QUANTUM_REGISTERS_CL_CPP
+#define QUANTUM_REGISTERS_CL_CPP
+
 #include <iostream>
 #include <complex>
 #include <vector>
@@ -32,11 +35,223 @@
 #include <random>
 #include <string>
 #include <bitset>
+#include <algorithm>
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <limits>
+#include <stdexcept>
+#include <variant>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+#include "Random_cl.cpp"
+#include "Parallel_cl.cpp"
+#include "Simd_cl.cpp"
+#include "Profile_cl.cpp"
+#include "StatePool_cl.cpp"
 
 #define COMPLEX std::complex
+
+/// Amplitudes per parallel reduction chunk: 16384 × 16 B = 256 KiB, about one L2 cache
+constexpr uint64_t kAmplitudesPerReduceChunk = uint64_t(1) << 14;
+
+/**
+ * @brief Gather the bits of value selected by mask into the low bits of the result
+ * @return Compacted bits, e.g. ExtractBits(0b1011, 0b1010) = 0b11
+ * 
+ * Maps a basis index to its outcome on a subset of qubits (partial measurement,
+ * marginal probabilities). A single PEXT instruction where BMI2 is available.
+ */
+inline uint64_t ExtractBits(uint64_t value, uint64_t mask)
+{
+#if defined(__BMI2__)
+    return _pext_u64(value, mask);
+#else
+    uint64_t result = 0;
+    for (uint64_t bit = 1; mask; bit <<= 1)
+    {
+        uint64_t lowest = mask & (~mask + 1);               // Lowest remaining selected bit
+        if (value & lowest)
+            result |= bit;
+        mask ^= lowest;
+    }
+    return result;
+#endif
+}
+
+/**
+ * @struct PauliString
+ * @brief Tensor product of I, X, Y, Z on the qubits of a register (no coefficient)
+ * 
+ * Stored symplectically as two masks: qubit q carries X if only xMask has
+ * bit q, Z if only zMask has it, and Y if both do. On a basis state
+ * 
+ *     P|i⟩ = i^{#Y} · (-1)^popcount(i & zMask) · |i ⊕ xMask⟩
+ * 
+ * since Y = i·X·Z. Built from a string (leftmost character = highest qubit,
+ * as in bitstrings) or by chaining:
+ * 
+ * PauliString zz = PauliString::FromString("ZZ");           // Z₁Z₀
+ * PauliString p = PauliString().X(3).Y(1).Z(0);             // X₃Y₁Z₀
+ */
+struct PauliString
+{
+    uint64_t xMask = 0;                          ///< Qubits with X or Y (flipped bits)
+    uint64_t zMask = 0;                          ///< Qubits with Z or Y (sign bits)
+
+    /**
+     * @brief Parse "XIZY"-style strings of I, X, Y, Z; the last character is qubit 0
+     */
+    static PauliString FromString(const std::string &ops)
+    {
+        assert(ops.size() <= 64 && "At most 64 qubits");
+        PauliString p;
+        const int n = static_cast<int>(ops.size());
+        for (int k = 0; k < n; ++k)
+        {
+            const int q = n - 1 - k;
+            switch (ops[k])
+            {
+            case 'I': break;
+            case 'X': p.X(q); break;
+            case 'Y': p.Y(q); break;
+            case 'Z': p.Z(q); break;
+            default: assert(false && "Pauli strings use only I, X, Y, Z");
+            }
+        }
+        return p;
+    }
+
+    PauliString &X(int q) { xMask |= uint64_t(1) << q; zMask &= ~(uint64_t(1) << q); return *this; }
+    PauliString &Y(int q) { xMask |= uint64_t(1) << q; zMask |= uint64_t(1) << q; return *this; }
+    PauliString &Z(int q) { xMask &= ~(uint64_t(1) << q); zMask |= uint64_t(1) << q; return *this; }
+
+    /**
+     * @brief Number of Y factors (the power of i in P|i⟩)
+     */
+    int YCount() const
+    {
+        return static_cast<int>(std::bitset<64>(xMask & zMask).count());
+    }
+};
+
+/**
+ * @struct PauliTerm
+ * @brief One weighted term c·P of an observable H = Σ c_t P_t
+ */
+struct PauliTerm
+{
+    double coefficient;
+    PauliString pauli;
+};
+
+/**
+ * @brief Installed physical memory of the host in bytes
+ * @return Byte count, or 0 if it cannot be determined
+ * 
+ * Used as the default state-vector memory budget so oversized registers fail
+ * up front instead of driving the host into swap.
+ */
+inline uint64_t PhysicalMemoryBytes()
+{
+#if defined(_WIN32)
+    MEMORYSTATUSEX status;
+    status.dwLength = sizeof(status);
+    return GlobalMemoryStatusEx(&status) ? static_cast<uint64_t>(status.ullTotalPhys) : 0;
+#elif defined(_SC_PHYS_PAGES) && defined(_SC_PAGE_SIZE)
+    long pages = sysconf(_SC_PHYS_PAGES);
+    long pageSize = sysconf(_SC_PAGE_SIZE);
+    return (pages > 0 && pageSize > 0) ? static_cast<uint64_t>(pages) * static_cast<uint64_t>(pageSize) : 0;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @class RegisterBudget
+ * @brief Process-wide state-vector memory budget shared by every register precision
+ * 
+ * BasicRegister<double> and BasicRegister<float> both check their allocation
+ * against this one budget, so Register::SetMemoryBudget() and
+ * RegisterF::SetMemoryBudget() name the same setting.
+ */
+class RegisterBudget
+{
+public:
+    /**
+     * @brief Bytes needed for an n-qubit state vector
+     * @param n Number of qubits
+     * @param amplitudeBytes Size of one amplitude (16 for complex<double>)
+     * @return 2^n × amplitudeBytes, saturated at UINT64_MAX on overflow
+     */
+    static uint64_t StateBytes(int n, uint64_t amplitudeBytes = sizeof(COMPLEX<double>))
+    {
+        if (n < 0 || n >= 64 || (uint64_t(1) << n) > std::numeric_limits<uint64_t>::max() / amplitudeBytes)
+            return std::numeric_limits<uint64_t>::max();
+        return (uint64_t(1) << n) * amplitudeBytes;
+    }
+    /**
+     * @brief Set the process-wide state-vector memory budget
+     * @param bytes Maximum bytes for one state vector (0 = unlimited)
+     */
+    static void SetMemoryBudget(uint64_t bytes)
+    {
+        memoryBudget.store(bytes);
+    }
+    /**
+     * @brief Current state-vector memory budget in bytes (0 = unlimited)
+     */
+    static uint64_t MemoryBudget()
+    {
+        return memoryBudget.load();
+    }
+    /**
+     * @brief Check whether an n-qubit state fits the budget and the address space
+     * @param n Number of qubits
+     * @param amplitudeBytes Size of one amplitude
+     */
+    static bool FitsMemoryBudget(int n, uint64_t amplitudeBytes = sizeof(COMPLEX<double>))
+    {
+        uint64_t bytes = StateBytes(n, amplitudeBytes);
+        if (bytes == std::numeric_limits<uint64_t>::max() || bytes / amplitudeBytes > std::numeric_limits<size_t>::max())
+            return false;                                   // 2^n not addressable on this host
+        uint64_t budget = MemoryBudget();
+        return budget == 0 || bytes <= budget;
+    }
+    /**
+     * @brief Fail fast if an n-qubit state cannot be allocated within budget
+     * @throws std::length_error with the required and allowed sizes
+     */
+    static void CheckMemoryBudget(int n, uint64_t amplitudeBytes = sizeof(COMPLEX<double>))
+    {
+        if (!FitsMemoryBudget(n, amplitudeBytes))
+        {
+            throw std::length_error("Register of " + std::to_string(n) + " qubits needs " +
+                                    std::to_string(StateBytes(n, amplitudeBytes)) + " bytes, memory budget is " +
+                                    std::to_string(MemoryBudget()) + " bytes");
+        }
+    }
+
+private:
+    static inline std::atomic<uint64_t> memoryBudget{PhysicalMemoryBytes()}; ///< Bytes allowed per state vector
+};
+
 /**
- * @class Register
+ * @class BasicRegister
  * @brief Quantum register implementation for multi-qubit quantum state representation
+ * @tparam T Amplitude scalar type: double (Register) or float (RegisterF)
  * 
  * This class implements a quantum register using the state vector formalism,
  * where quantum states are represented as vectors in a complex Hilbert space.
@@ -52,12 +267,47 @@
  * Memory Layout:
  * For n qubits, val[i] stores the amplitude of basis state |binary(i)⟩
  * Example for 2 qubits: val[0]=|00⟩, val[1]=|01⟩, val[2]=|10⟩, val[3]=|11⟩
+ * 
+ * Randomness:
+ * Each register owns its own RandomEngine (xoshiro256**), seeded from
+ * std::random_device by default. Call Seed() for bit-reproducible runs.
+ * 
+ * Indexing & Memory Budget:
+ * All basis indices are uint64_t, so registers beyond 31 qubits index
+ * correctly. Before allocating, constructors check 2^n × sizeof(amplitude)
+ * against a process-wide budget (default: installed physical memory, see
+ * SetMemoryBudget) and throw std::length_error instead of thrashing or OOMing.
+ * 
+ * Precision:
+ * Register (complex<double>, 16 B/amplitude) is the default. RegisterF
+ * (complex<float>, 8 B/amplitude) halves memory and bandwidth — one more qubit
+ * per node and roughly twice the gate throughput on large, memory-bound
+ * states — at ~1e-7 relative amplitude precision, ample for sampling.
+ * Reductions (norm, inner product, probabilities) are accumulated in double
+ * for both. To pick the precision at run time see AnyRegister / MakeRegister.
+ * 
+ * Allocation:
+ * The state vector and Sample()'s cumulative table come from a StatePool
+ * (StatePool_cl.cpp) through the Allocator handle, StatePool::Default()
+ * unless one is passed to the constructor. Destroyed registers return their
+ * buffers to the pool, so the next register of the same width reuses memory
+ * that is already mapped (and huge-page backed) instead of faulting in fresh
+ * pages. Copies share the source's pool. Fresh state vectors are
+ * zero-filled by the thread pool (first touch in parallel), and a filled
+ * StateVector can be moved into a register without a copy.
  */
-class Register
+template <typename T>
+class BasicRegister : public RegisterBudget
 {
 public:
+    using RandomEngine = Xoshiro256;             ///< Engine type driving measurement draws
+    using Scalar = T;                            ///< Amplitude component type
+    using Amplitude = std::complex<T>;           ///< Stored amplitude type
+    using Allocator = PoolAllocator<Amplitude>;  ///< State-vector allocator (handle on a StatePool)
+    using StateVector = std::vector<Amplitude, Allocator>;  ///< Type of val (movable into a register)
+
     int bits;                                    ///< Number of qubits in the register
-    std::vector<std::complex<double>> val;       ///< State vector storing probability amplitudes
+    StateVector val;                             ///< State vector storing probability amplitudes
     /**
      * @brief Default constructor creating quantum register in |00...0⟩ state
      * @param n Number of qubits in the register
@@ -68,19 +318,22 @@ public:
      * State Created: |ψ⟩ = |00...0⟩ (all qubits in |0⟩ state)
      * Probability Amplitude: val[0] = 1+0i, val[i>0] = 0+0i
      * 
+     * @param alloc Pool the state vector is drawn from (default: StatePool::Default())
+     * @throws std::length_error if the state vector exceeds the memory budget
      * @complexity Time: O(2^n), Space: O(2^n)
      */
-    Register(int n) : bits(n)
+    BasicRegister(int n, const Allocator &alloc = Allocator()) : bits(n), val(alloc)
     {
-        int resizeFactor = 1 << n;                          // Calculate 2^n states
-        val.resize(resizeFactor, COMPLEX<double>(0.0f, 0.0f)); // Initialize all to zero
-        val[0] = COMPLEX(1.0f, 0.0f);                       // Set |00...0⟩ amplitude to 1
-        Normalise();                                        // Ensure normalization
+        ZeroFill(StateSize(n));                             // 2^n zeros (budget-checked), filled in parallel
+        val[0] = Amplitude(1, 0);                           // Set |00...0⟩ amplitude to 1
+        cache.norm = 1.0;                                   // Exactly normalised: no pass needed
+        cache.normValid = true;
     }
     /**
      * @brief Constructor with custom initial state specification
      * @param n Number of qubits in the register
      * @param initStates Map from binary strings to complex amplitudes
+     * @param alloc Pool the state vector is drawn from (default: StatePool::Default())
      * 
      * Creates a quantum register with arbitrary initial superposition state.
      * Allows specification of custom probability amplitudes for each basis state.
@@ -96,13 +349,16 @@ public:
      * };
      * Register reg(2, states);    // Creates superposition 0.6|00⟩ + 0.8|11⟩
      * 
-     * @note The state is automatically normalized after initialization
+     * @note The state is automatically normalized after initialization; amplitudes
+     *       are given in double and rounded to T
+     * @throws std::length_error if the state vector exceeds the memory budget
      * @complexity Time: O(2^n + m), Space: O(2^n) where m = initStates.size()
      */
-    Register(int n, const std::map<std::string, std::complex<double>> &initStates) : bits(n)
+    BasicRegister(int n, const std::map<std::string, std::complex<double>> &initStates, const Allocator &alloc = Allocator())
+        : bits(n), val(alloc)
     {
-        int size = 1 << n;                                  // Calculate 2^n states
-        val.resize(size, COMPLEX<double>(0.0, 0.0));        // Initialize all amplitudes to zero
+        uint64_t size = StateSize(n);                       // Calculate 2^n states (budget-checked)
+        ZeroFill(size);                                     // Initialize all amplitudes to zero
 
         // Set amplitudes for specified basis states
         for (const auto &[bitstring, amplitude] : initStates)
@@ -111,14 +367,90 @@ public:
             assert(static_cast<int>(bitstring.length()) == n && "Bitstring length must match register size");
             
             // Convert binary string to state index
-            int index = std::stoi(bitstring, nullptr, 2);    // Binary to integer conversion
+            uint64_t index = std::stoull(bitstring, nullptr, 2); // Binary to integer conversion (64-bit)
             assert(index < size && "Index out of bounds for register size");
             
-            val[index] = amplitude;                          // Set amplitude for this basis state
+            val[index] = Amplitude(amplitude);               // Set amplitude for this basis state
         }
 
         Normalise();                                         // Normalize the quantum state
     }
+    /**
+     * @brief Constructor from parallel arrays of basis indices and amplitudes
+     * @param n Number of qubits in the register
+     * @param indices Basis indices (bit q = qubit q), each < 2^n and listed at most once
+     * @param amplitudes Amplitude of each listed index
+     * @param count Number of entries in both arrays
+     * @param alloc Pool the state vector is drawn from (default: StatePool::Default())
+     * 
+     * The sparse counterpart of the bitstring map for data-loaded states:
+     * no strings are parsed and nothing is sorted, the entries are scattered
+     * straight into the zero-filled state in parallel. The state is
+     * normalised afterwards, as with the map constructor.
+     * 
+     * Example Usage:
+     * std::vector<uint64_t> idx = {0b00, 0b11};
+     * std::vector<std::complex<double>> amp = {0.6, 0.8};
+     * Register reg(2, idx, amp);  // 0.6|00⟩ + 0.8|11⟩
+     * 
+     * @throws std::length_error if the state vector exceeds the memory budget
+     * @complexity Time: O(2^n + m), Space: O(2^n) where m = count
+     */
+    BasicRegister(int n, const uint64_t *indices, const std::complex<double> *amplitudes, size_t count,
+                  const Allocator &alloc = Allocator())
+        : bits(n), val(alloc)
+    {
+        const uint64_t size = StateSize(n);
+        ZeroFill(size);
+        Amplitude *amp = val.data();
+        ThreadPool::Instance().ParallelFor(count, kAmplitudesPerReduceChunk, [=](uint64_t begin, uint64_t end) {
+            for (uint64_t k = begin; k < end; ++k)
+            {
+                assert(indices[k] < size && "Index out of bounds for register size");
+                amp[indices[k]] = Amplitude(amplitudes[k]);
+            }
+        });
+        Normalise();
+    }
+    BasicRegister(int n, const std::vector<uint64_t> &indices, const std::vector<std::complex<double>> &amplitudes,
+                  const Allocator &alloc = Allocator())
+        : BasicRegister(n, indices.data(), amplitudes.data(),
+                        (assert(indices.size() == amplitudes.size() && "One amplitude per index"), indices.size()), alloc)
+    {
+    }
+    /**
+     * @brief Constructor adopting a full state vector without copying it
+     * @param n Number of qubits in the register
+     * @param amplitudes 2^n amplitudes (bit q of the index = qubit q), moved in
+     * 
+     * The buffer becomes the register's state vector and its pool the
+     * register's pool; the caller can fill it in place first, e.g.
+     * Register::StateVector buf(std::size_t(1) << n); Load(buf.data()); Register reg(n, std::move(buf));
+     * The state is normalised (one parallel pass).
+     * 
+     * @throws std::length_error if the state vector exceeds the memory budget
+     * @complexity Time: O(2^n), Space: O(1) beyond the buffer
+     */
+    BasicRegister(int n, StateVector &&amplitudes) : bits(n), val(std::move(amplitudes))
+    {
+        const uint64_t size = StateSize(n);                 // Budget-checked
+        assert(val.size() == size && "Buffer must hold 2^n amplitudes");
+        (void)size;
+        Normalise();
+    }
+
+    /**
+     * @brief Copy and move construction
+     * 
+     * Copies duplicate the full 2^n state (and the random engine state); pass
+     * registers by const reference wherever the state is only read. Moves
+     * transfer the state vector in O(1), e.g. returning a prepared register
+     * from a function or storing it in a container.
+     */
+    BasicRegister(const BasicRegister &) = default;
+    BasicRegister(BasicRegister &&) noexcept = default;
+    BasicRegister &operator=(const BasicRegister &) = default;
+    BasicRegister &operator=(BasicRegister &&) noexcept = default;
 
     /**
      * @brief Calculate sum of squared magnitudes of all amplitudes
@@ -134,16 +466,51 @@ public:
      * - Probability conservation checking
      * - Quantum state validation
      * 
-     * @complexity Time: O(2^n), Space: O(1)
+     * Parallel over cache-sized chunks; partial sums combine in a fixed
+     * order, so the result does not depend on the thread count.
+     * 
+     * The sum is cached until the state changes in a way that can alter it
+     * (see MarkDirty); gates keep it, so repeated calls between measurements
+     * are O(1).
+     * 
+     * @complexity Time: O(2^n) when the cache is cold, O(1) otherwise; Space: O(1)
      */
     double MagnitudeSquareSum() const
     {
-        double result = 0.0;
-        for (const auto &i : val)
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        if (!cache.normValid)
         {
-            result += std::norm(i);                         // |α|² = α*α* (squared magnitude)
+            const Amplitude *amp = val.data();
+            cache.norm = ThreadPool::Instance().ParallelReduce(val.size(), kAmplitudesPerReduceChunk, 0.0,
+                [amp](uint64_t begin, uint64_t end) {
+                    return SimdNormSum(amp + begin, end - begin); // Σ |α|² = Σ (re² + im²), vectorised
+                });
+            cache.normValid = true;
         }
-        return result;
+        return cache.norm;
+    }
+    /**
+     * @brief Declare that val has changed, dropping the cached norm and distributions
+     * @param normPreserved True for unitary updates (gates), which keep Σ|αᵢ|²
+     * 
+     * The register caches MagnitudeSquareSum(), per-block probability sums
+     * for single draws (MeasureIndex, Collapse) and the cumulative table of
+     * Sample(), and reuses them while the state is unchanged. Every gate,
+     * circuit, oracle and restore in this library calls MarkDirty() on the
+     * registers it writes; code that writes val directly must do the same.
+     * 
+     * @complexity Time: O(1) (the Sample() table, if any, is released)
+     */
+    void MarkDirty(bool normPreserved = false)
+    {
+        cache.blocksValid = false;
+        if (cache.cumulativeValid)
+        {
+            Scratch(PoolAllocator<double>(val.get_allocator())).swap(cache.cumulative);
+            cache.cumulativeValid = false;
+        }
+        if (!normPreserved)
+            cache.normValid = false;
     }
     /**
      * @brief Get measurement probability for a specific basis state
@@ -162,9 +529,30 @@ public:
      * 
      * @complexity Time: O(1), Space: O(1)
      */
-    double GetProbab(int i)
+    double GetProbab(uint64_t i) const
+    {
+        return double(std::norm(val[i]));                   // Born rule: P(i) = |αᵢ|²
+    }
+    /**
+     * @brief Copy another register's state into this one, reusing the allocation
+     * @param other Register with the same number of qubits
+     * 
+     * Unlike copy assignment, never reallocates (or frees) the state vector and
+     * copies in parallel cache-sized chunks, so a scratch register can be reset
+     * to a reference state inside a loop at memory bandwidth. The random
+     * engine is left untouched.
+     * 
+     * @complexity Time: O(2^n), Space: O(1)
+     */
+    void CopyStateFrom(const BasicRegister &other)
     {
-        return std::norm(val[i]);                           // Born rule: P(i) = |αᵢ|²
+        assert(val.size() == other.val.size() && "Registers must have the same size");
+        const Amplitude *src = other.val.data();
+        Amplitude *dst = val.data();
+        ThreadPool::Instance().ParallelFor(val.size(), kAmplitudesPerReduceChunk, [=](uint64_t begin, uint64_t end) {
+            std::copy(src + begin, src + end, dst + begin);
+        });
+        MarkDirty();
     }
     /**
      * @brief Calculate inner product between two quantum states
@@ -186,17 +574,156 @@ public:
      * - ⟨ψ|φ⟩ = ⟨φ|ψ⟩* (conjugate symmetry)
      * - |⟨ψ|φ⟩|² = probability of measuring |ψ⟩ when starting from |φ⟩
      * 
+     * The other register is taken by const reference (no copy) and both
+     * states are streamed once, vectorised and in parallel chunks.
+     * 
+     * @complexity Time: O(2^n), Space: O(1)
+     */
+    COMPLEX<double> FindInnerProduct(const BasicRegister &other) const
+    {
+        assert(val.size() == other.val.size());
+        return FindInnerProduct(other.val.data(), other.val.size());
+    }
+    /**
+     * @brief Inner product ⟨ψ|φ⟩ with a raw amplitude span
+     * @param other First amplitude of |φ⟩ (e.g., another vector's data())
+     * @param size Number of amplitudes, must equal 2^n
+     * 
+     * Lets states held outside a Register (buffers, memory-mapped files) be
+     * compared without wrapping or copying them.
+     * 
+     * @complexity Time: O(2^n), Space: O(1)
+     */
+    COMPLEX<double> FindInnerProduct(const Amplitude *other, uint64_t size) const
+    {
+        assert(size == val.size() && "Span size must match register size");
+        const Amplitude *amp = val.data();
+        return ThreadPool::Instance().ParallelReduce(size, kAmplitudesPerReduceChunk, COMPLEX<double>(0.0, 0.0),
+            [amp, other](uint64_t begin, uint64_t end) {
+                return SimdInnerProduct(amp + begin, other + begin, end - begin); // ⟨ψ|φ⟩ = Σᵢ ψᵢ* φᵢ
+            });
+    }
+    /**
+     * @brief State fidelity F = |⟨ψ|φ⟩|² / (⟨ψ|ψ⟩⟨φ|φ⟩)
+     * @param other Register with the same number of qubits
+     * @return Fidelity in [0, 1]; 1 for identical states up to global phase
+     * 
+     * The inner product and both norms come from one fused pass
+     * (SimdOverlap), so the result is exact even if either state has drifted
+     * from unit norm, at the memory cost of a single inner product.
+     * 
      * @complexity Time: O(2^n), Space: O(1)
      */
-    COMPLEX<double> FindInnerProduct(Register other) const
+    double Fidelity(const BasicRegister &other) const
     {
         assert(val.size() == other.val.size());
-        COMPLEX<double> IP = COMPLEX<double>(0.0, 0.0);
-        for (size_t i = 0; i < val.size(); i++)
+        const Amplitude *a = val.data();
+        const Amplitude *b = other.val.data();
+        Overlap o = ThreadPool::Instance().ParallelReduce(val.size(), kAmplitudesPerReduceChunk, Overlap{},
+            [a, b](uint64_t begin, uint64_t end) { return SimdOverlap(a + begin, b + begin, end - begin); });
+        return std::norm(o.inner) / (o.normA * o.normB);
+    }
+    /**
+     * @brief Expectation value of a diagonal observable: ⟨ψ|D|ψ⟩ = Σᵢ dᵢ·|αᵢ|²
+     * @param diagonal Observable eigenvalue dᵢ of each basis state (size 2^n)
+     * 
+     * Example: the cost function of a classical optimisation problem encoded
+     * as one value per bitstring.
+     * 
+     * @complexity Time: O(2^n), Space: O(1)
+     */
+    double ExpectationDiagonal(const std::vector<double> &diagonal) const
+    {
+        assert(diagonal.size() == val.size() && "One eigenvalue per basis state");
+        const Amplitude *amp = val.data();
+        const double *d = diagonal.data();
+        return ThreadPool::Instance().ParallelReduce(val.size(), kAmplitudesPerReduceChunk, 0.0,
+            [amp, d](uint64_t begin, uint64_t end) {
+                double sum = 0.0;
+                for (uint64_t i = begin; i < end; ++i)
+                    sum += d[i] * double(std::norm(amp[i]));
+                return sum;
+            });
+    }
+    /**
+     * @brief Expectation value of a product of Pauli-Z operators
+     * @param qubitMask Bitmask of the qubits carrying Z (e.g., 0b101 for Z₂Z₀)
+     * @return ⟨ψ|Z...Z|ψ⟩ = Σᵢ (-1)^popcount(i & mask)·|αᵢ|², in [-1, 1]
+     * 
+     * @complexity Time: O(2^n), Space: O(1)
+     */
+    double ExpectationZ(uint64_t qubitMask) const
+    {
+        const Amplitude *amp = val.data();
+        return ThreadPool::Instance().ParallelReduce(val.size(), kAmplitudesPerReduceChunk, 0.0,
+            [amp, qubitMask](uint64_t begin, uint64_t end) {
+                double sum = 0.0;
+                for (uint64_t i = begin; i < end; ++i)
+                {
+                    double p = double(std::norm(amp[i]));
+                    sum += (std::bitset<64>(i & qubitMask).count() & 1) ? -p : p;
+                }
+                return sum;
+            });
+    }
+    /**
+     * @brief Exact expectation value ⟨ψ|P|ψ⟩ of a Pauli string, without sampling
+     * @return Real value in [-1, 1] for a normalised state; the state is not modified
+     * 
+     * With x = xMask, P|i⟩ = i^{#Y}·sᵢ·|i ⊕ x⟩ (sᵢ = (-1)^popcount(i & zMask)),
+     * the amplitudes i and i ⊕ x pair up, and each pair contributes
+     * 
+     *     2·sᵢ·Re(i^{#Y} · conj(α_{i⊕x})·αᵢ)
+     * 
+     * (the two terms of a pair are complex conjugates because P is Hermitian).
+     * One parallel pass over the 2^(n-1) pairs reads every amplitude once;
+     * pure-Z strings (x = 0) reduce to ExpectationZ.
+     * 
+     * Example: PauliString::FromString("ZZ") on (|00⟩ + |11⟩)/√2 gives 1,
+     * "XX" gives 1 and "YY" gives -1.
+     * 
+     * @complexity Time: O(2^n), Space: O(1)
+     */
+    double Expectation(const PauliString &pauli) const
+    {
+        return Expectation(std::vector<PauliTerm>{{1.0, pauli}});
+    }
+    /**
+     * @brief Expectation value of a weighted Pauli sum ⟨ψ|Σ c_t P_t|ψ⟩
+     * @param terms Observable terms (e.g. a Hamiltonian)
+     * 
+     * Terms are grouped by their X/Y support (xMask): every group pairs the
+     * same amplitudes, so it is evaluated in one shared pass that computes
+     * conj(α_{i⊕x})·αᵢ once per pair and applies each term's sign and
+     * coefficient to it. All diagonal terms (products of Z, e.g. a qubit-wise
+     * commuting Z-basis group) therefore cost one pass in total, and so do
+     * terms such as XX and YY that share an X/Y support.
+     * 
+     * @complexity Time: O(2^n · (G + T)) for G distinct supports and T terms, Space: O(T)
+     */
+    double Expectation(const std::vector<PauliTerm> &terms) const
+    {
+        std::map<uint64_t, std::vector<PauliTerm>> groups;  // xMask → terms
+        for (const PauliTerm &t : terms)
         {
-            IP += std::conj(val[i]) * other.val[i];         // ⟨ψ|φ⟩ = Σᵢ ψᵢ* φᵢ
+            assert(((t.pauli.xMask | t.pauli.zMask) >> bits) == 0 && "Pauli string acts outside the register");
+            groups[t.pauli.xMask].push_back(t);
         }
-        return IP;
+
+        double total = 0.0;
+        for (const auto &[xMask, group] : groups)
+        {
+            // Per term: sign mask and the real factor left after applying i^{#Y}
+            struct Factor { uint64_t zMask; double weight; bool imaginary; };
+            std::vector<Factor> factors;
+            for (const PauliTerm &t : group)
+            {
+                const int y = t.pauli.YCount() & 3;                 // i^{#Y} ∈ {1, i, -1, -i}
+                factors.push_back({t.pauli.zMask, (y == 0 || y == 3) ? t.coefficient : -t.coefficient, (y & 1) != 0});
+            }
+            total += xMask ? PairedPass(xMask, factors) : DiagonalPass(factors);
+        }
+        return total;
     }
     /**
      * @brief Print quantum state in Dirac notation
@@ -220,11 +747,11 @@ public:
     void Print() const
     {
         std::cout << "|ψ⟩ = ";
-        int n = std::log2(val.size());                      // Number of qubits
+        int n = bits;                                       // Number of qubits
         bool first = true;
 
         // Iterate through all basis states
-        for (size_t i = 0; i < val.size(); ++i)
+        for (uint64_t i = 0; i < val.size(); ++i)
         {
             // Skip terms with negligible amplitude
             if (std::abs(val[i]) < 1e-6)
@@ -255,11 +782,10 @@ public:
      * the quantum state to collapse to a definite computational basis state.
      * 
      * Algorithm:
-     * 1. Calculate cumulative probability distribution from |αᵢ|²
-     * 2. Generate random number r ∈ [0,1)
-     * 3. Find first index i where cumulative_prob[i] > r
-     * 4. Collapse state: set val[i] = 1, val[j≠i] = 0
-     * 5. Return binary representation of measured state i
+     * 1. Generate random number r ∈ [0,1)
+     * 2. Find first index i where Σ_{k ≤ i} |αₖ|² > r·Σₖ|αₖ|² (see CollapseIndex)
+     * 3. Collapse state: set val[i] = 1, val[j≠i] = 0
+     * 4. Return binary representation of measured state i
      * 
      * Physical Interpretation:
      * - Models the irreversible process of quantum measurement
@@ -272,45 +798,48 @@ public:
      * - After measurement, state becomes either |00⟩ or |11⟩
      * 
      * @note This function modifies the quantum state (destructive measurement)
-     * @complexity Time: O(2^n), Space: O(2^n) for cumulative array
+     * @note Builds a result string; in shot loops prefer CollapseIndex()
+     * @complexity Time: O(2^n), Space: O(n) for the returned string
      */
     std::string Collapse()
     {
-        EnsureRandomSeeded();
-        
-        // Build cumulative probability distribution
-        std::vector<double> cumulative;
-        double total = 0.0;
-        for (const auto &amp : val)
-        {
-            total += std::norm(amp);                        // Add |αᵢ|² to cumulative sum
-            cumulative.push_back(total);
-        }
-
-        // Generate random number for measurement outcome
-        double r = static_cast<double>(rand()) / RAND_MAX;
-
-        // Find measured state using cumulative distribution
-        size_t collapsedIndex = 0;
-        for (; collapsedIndex < cumulative.size(); ++collapsedIndex)
-        {
-            if (r < cumulative[collapsedIndex])
-                break;
-        }
+        return IndexToBitstring(CollapseIndex());
+    }
+    /**
+     * @brief Collapsing measurement returning the packed basis index
+     * @return Measured index i (bit j = qubit j), the state is left in |i⟩
+     * 
+     * Allocation-free hot path behind Collapse(): no cumulative table, no
+     * string. The draw is located by one scan over block norm sums (see
+     * DrawIndex) and the collapse is a parallel fill.
+     * 
+     * @complexity Time: O(2^n), Space: O(1)
+     */
+    uint64_t CollapseIndex()
+    {
+        PROFILE_SCOPE("Collapse", -1, val.size(), val.size() * sizeof(Amplitude) * 5 / 2);
+        uint64_t collapsedIndex = DrawIndex(rng.UniformDouble());
 
         // Collapse the state vector to measured outcome
-        for (size_t i = 0; i < val.size(); ++i)
-        {
-            val[i] = (i == collapsedIndex) ? COMPLEX(1.0, 0.0) : COMPLEX(0.0, 0.0);
-        }
-
-        // Convert measured state index to binary string
-        std::string result;
-        for (int j = bits - 1; j >= 0; --j)
-        {
-            result += std::to_string((collapsedIndex >> j) & 1);
-        }
-        return result;
+        Amplitude *amp = val.data();
+        ThreadPool::Instance().ParallelFor(val.size(), kAmplitudesPerReduceChunk, [=](uint64_t begin, uint64_t end) {
+            std::fill(amp + begin, amp + end, Amplitude(0, 0));
+        });
+        amp[collapsedIndex] = Amplitude(1, 0);
+        MarkDirty();
+        cache.norm = 1.0;                                   // A basis state: norm known exactly
+        cache.normValid = true;
+        return collapsedIndex;
+    }
+    /**
+     * @brief Collapsing measurement written into a caller-provided bitset
+     * @param outcome Receives the measured bits (bit j = qubit j); N ≥ bits
+     */
+    template <size_t N>
+    void Collapse(std::bitset<N> &outcome)
+    {
+        assert(static_cast<size_t>(bits) <= N && "Bitset too small for the register");
+        outcome = std::bitset<N>(CollapseIndex());
     }
     /**
      * @brief Perform quantum measurement without state collapse
@@ -333,58 +862,568 @@ public:
      * - Useful for statistical analysis
      * 
      * Algorithm:
-     * 1. Build cumulative probability distribution from |αᵢ|²
-     * 2. Sample random outcome according to Born rule
-     * 3. Return measurement result as binary string
-     * 4. Preserve original quantum state
+     * 1. Draw r ∈ [0,1) and locate the outcome by Born rule (MeasureIndex)
+     * 2. Return measurement result as binary string
+     * 3. Preserve original quantum state
      * 
      * Example Usage:
      * Register reg(2);  // |00⟩ state
      * // Apply gates to create superposition...
      * for(int i = 0; i < 1000; i++) {
-     *     std::string outcome = reg.MeasureWithoutCollapse();
+     *     uint64_t outcome = reg.MeasureIndex();   // No string per shot
      *     // Collect statistics...
      * }
      * // reg still contains original superposition state
      * 
      * @note This function does NOT modify the quantum state
-     * @complexity Time: O(2^n), Space: O(2^n) for cumulative array
+     * @note Builds a result string; in shot loops prefer MeasureIndex() or Sample()
+     * @complexity Time: O(2^n), Space: O(n) for the returned string
      */
     std::string MeasureWithoutCollapse()
     {
-        EnsureRandomSeeded();
-        
-        // Build cumulative probability distribution (same as Collapse)
-        std::vector<double> cumulative;
+        return IndexToBitstring(MeasureIndex());
+    }
+    /**
+     * @brief Non-collapsing measurement returning the packed basis index
+     * @return Sampled index i with probability |αᵢ|² / Σ|αₖ|²
+     * 
+     * @note This function does NOT modify the quantum state
+     * @complexity Time: O(2^n), Space: O(1), no heap allocation
+     */
+    uint64_t MeasureIndex()
+    {
+        PROFILE_SCOPE("MeasureIndex", -1, val.size(), val.size() * sizeof(Amplitude) * 3 / 2);
+        return DrawIndex(rng.UniformDouble());
+    }
+    /**
+     * @brief Non-collapsing measurement with a caller-supplied engine
+     * 
+     * Const, so threads may measure one register concurrently with their
+     * own engines (as with Sample(shots, engine)).
+     */
+    uint64_t MeasureIndex(RandomEngine &engine) const
+    {
+        PROFILE_SCOPE("MeasureIndex", -1, val.size(), val.size() * sizeof(Amplitude) * 3 / 2);
+        return DrawIndex(engine.UniformDouble());
+    }
+    /**
+     * @brief Non-collapsing measurement written into a caller-provided bitset
+     * @param outcome Receives the measured bits (bit j = qubit j); N ≥ bits
+     */
+    template <size_t N>
+    void MeasureWithoutCollapse(std::bitset<N> &outcome)
+    {
+        assert(static_cast<size_t>(bits) <= N && "Bitset too small for the register");
+        outcome = std::bitset<N>(MeasureIndex());
+    }
+    /**
+     * @brief Marginal outcome probabilities of a subset of qubits
+     * @param qubitMask Bitmask of the measured qubits (k = popcount bits set)
+     * @return 2^k probabilities; entry j is P(measured bits = j), with the
+     *         masked qubits compacted in ascending order (lowest masked qubit = bit 0)
+     * 
+     * One parallel pass over the state: every amplitude adds |αᵢ|² to the
+     * entry ExtractBits(i, mask). Chunks are sized so there are at most 256
+     * partial histograms, summed in a fixed order (thread-count independent).
+     * 
+     * @complexity Time: O(2^n), Space: O(2^k · min(256, 2^n / 16384))
+     */
+    std::vector<double> MarginalProbabilities(uint64_t qubitMask) const
+    {
+        assert(qubitMask != 0 && (qubitMask >> bits) == 0 && "Mask must select qubits of this register");
+        const int k = static_cast<int>(std::bitset<64>(qubitMask).count());
+        assert(k <= 24 && "Marginal table limited to 2^24 outcomes");
+        PROFILE_SCOPE("Marginal", -1, val.size(), val.size() * sizeof(Amplitude));
+
+        struct Histogram
+        {
+            std::vector<double> p;
+            Histogram &operator+=(const Histogram &other)
+            {
+                if (p.empty())
+                    p.resize(other.p.size(), 0.0);
+                for (size_t j = 0; j < other.p.size(); ++j)
+                    p[j] += other.p[j];
+                return *this;
+            }
+        };
+
+        const Amplitude *amp = val.data();
+        const uint64_t chunk = std::max<uint64_t>(kAmplitudesPerReduceChunk, val.size() / 256);
+        Histogram total = ThreadPool::Instance().ParallelReduce(val.size(), chunk, Histogram{},
+            [amp, qubitMask, k](uint64_t begin, uint64_t end) {
+                Histogram h{std::vector<double>(size_t(1) << k, 0.0)};
+                for (uint64_t i = begin; i < end; ++i)
+                    h.p[ExtractBits(i, qubitMask)] += double(std::norm(amp[i]));
+                return h;
+            });
+        return total.p;
+    }
+    /**
+     * @brief Measure a subset of qubits, collapsing only what the outcome rules out
+     * @param qubitMask Bitmask of the qubits to measure (e.g., 0b100 for qubit 2)
+     * @return The measured bits in place: bit q of the result is qubit q's
+     *         outcome for every q in the mask, all other bits are 0
+     * 
+     * Mid-circuit measurement of ancillas without measuring (and destroying)
+     * the rest of the register.
+     * 
+     * Algorithm:
+     * 1. Marginal probabilities of the 2^k outcomes in one parallel pass
+     * 2. Draw an outcome m by Born rule on the marginals
+     * 3. In place and in parallel: zero every amplitude whose masked bits
+     *    differ from m, scale the consistent ones by 1/√P(m)
+     * The unmeasured qubits keep their (conditional) superposition:
+     * (|00⟩ + |11⟩)/√2 measured on qubit 0 leaves |00⟩ or |11⟩, and
+     * (|0⟩ + |1⟩)⊗|1⟩/√2 measured on qubit 0 leaves qubit 1 untouched.
+     * 
+     * Example: int ancilla = reg.Measure(uint64_t(1) << 0) ? 1 : 0;
+     * 
+     * @note Measure(all qubits) is equivalent to CollapseIndex()
+     * @complexity Time: O(2^n) in two passes, Space: O(2^k) marginals
+     */
+    uint64_t Measure(uint64_t qubitMask)
+    {
+        std::vector<double> marginal = MarginalProbabilities(qubitMask);
+        PROFILE_SCOPE("Measure", -1, val.size(), 2 * val.size() * sizeof(Amplitude));   // Draw + projection
+
         double total = 0.0;
-        for (const auto &amp : val)
+        for (double p : marginal)
+            total += p;
+        const double target = rng.UniformDouble() * total;
+        uint64_t outcome = 0;                               // Compacted outcome index
+        double running = 0.0;
+        for (uint64_t j = 0; j < marginal.size(); ++j)
         {
-            total += std::norm(amp);                        // Add |αᵢ|² to cumulative sum
-            cumulative.push_back(total);
+            if (marginal[j] > 0.0)
+                outcome = j;                                // Fallback: last possible outcome
+            running += marginal[j];
+            if (running > target)
+                break;
         }
 
-        // Generate random number for measurement outcome
-        double r = static_cast<double>(rand()) / RAND_MAX;
+        // Scatter the compacted outcome back onto the qubit positions
+        uint64_t measured = 0;
+        uint64_t bit = 0;
+        for (uint64_t m = qubitMask; m; m &= m - 1, ++bit)
+        {
+            if ((outcome >> bit) & 1)
+                measured |= m & (~m + 1);
+        }
 
-        // Find measured state using cumulative distribution
-        size_t measuredIndex = 0;
-        for (; measuredIndex < cumulative.size(); ++measuredIndex)
+        const T scale = T(1.0 / std::sqrt(marginal[outcome]));
+        Amplitude *amp = val.data();
+        ThreadPool::Instance().ParallelFor(val.size(), kAmplitudesPerReduceChunk,
+            [amp, qubitMask, measured, scale](uint64_t begin, uint64_t end) {
+                for (uint64_t i = begin; i < end; ++i)
+                    amp[i] = ((i & qubitMask) == measured) ? amp[i] * scale : Amplitude(0, 0);
+            });
+        MarkDirty();
+        return measured;
+    }
+    /**
+     * @brief Draw many measurement shots from the same quantum state
+     * @param shots Number of independent samples to draw
+     * @return Histogram mapping measured basis index → number of occurrences
+     * 
+     * Batched counterpart of MeasureWithoutCollapse(). The cumulative
+     * distribution over |αᵢ|² is built exactly once, and every shot is then
+     * resolved by binary search instead of a fresh 2^n scan. The table stays
+     * cached until the state changes, so repeated Sample() calls on the same
+     * state skip step 1; runs of fewer than 2^n / kReduceBlock shots use the
+     * (much smaller) per-block table of MeasureIndex() instead.
+     * 
+     * Algorithm:
+     * 1. Build cumulative probability array c[i] = Σ_{k ≤ i} |αₖ|² (once)
+     * 2. For each shot draw r ∈ [0,1) and binary search the first c[i] > r
+     * 3. Increment the count of that basis index
+     * 
+     * Example Usage:
+     * Register reg(3);
+     * // Apply gates...
+     * std::map<uint64_t, size_t> counts = reg.Sample(100000);
+     * for (const auto &[index, count] : counts)
+     *     std::cout << reg.IndexToBitstring(index) << ": " << count << std::endl;
+     * 
+     * @note This function does NOT modify the quantum state
+     * @complexity Time: O(2^n + shots·n), Space: O(2^n) for cumulative array
+     */
+    std::map<uint64_t, size_t> Sample(size_t shots)
+    {
+        return Sample(shots, rng);
+    }
+    /**
+     * @brief Draw measurement shots using a caller-supplied random engine
+     * @param shots Number of independent samples to draw
+     * @param engine Random engine to draw from (advanced in place)
+     * @return Histogram mapping measured basis index → number of occurrences
+     * 
+     * Const and thread-safe (the shared caches are built under a lock), so
+     * several threads can sample the same register concurrently, each with
+     * its own stream:
+     * 
+     * Register::RandomEngine worker(seed, threadId);
+     * auto partial = reg.Sample(shotsPerThread, worker);
+     * 
+     * @complexity Time: O(2^n + shots·n), Space: O(2^n) for cumulative array
+     */
+    std::map<uint64_t, size_t> Sample(size_t shots, RandomEngine &engine) const
+    {
+        std::map<uint64_t, size_t> histogram;
+        SampleEach(shots, engine, [&histogram](uint64_t index) { ++histogram[index]; });
+        return histogram;
+    }
+    /**
+     * @brief Draw measurement shots and hand each basis index to a callback
+     * @param shots Number of independent samples to draw
+     * @param engine Random engine to draw from (advanced in place)
+     * @param record Called as record(uint64_t index) once per shot, in draw order
+     * 
+     * The streaming form of Sample(): shots are never collected, so a sink
+     * (e.g. MeasurementSink) can buffer, aggregate or write them as packed
+     * integers without a histogram or bitstring per shot.
+     * 
+     * @complexity Time: O(2^n + shots·n), Space: O(2^n) for cumulative array
+     */
+    template <typename F>
+    void SampleEach(size_t shots, RandomEngine &engine, F &&record) const
+    {
+        PROFILE_SCOPE("Sample", -1, val.size(), val.size() * (sizeof(Amplitude) + sizeof(double)));
+        if (shots < val.size() / kReduceBlock)
         {
-            if (r < cumulative[measuredIndex])
-                break;
+            for (size_t shot = 0; shot < shots; ++shot)
+                record(DrawIndex(engine.UniformDouble()));  // One block scan per shot beats a 2^n table
+            return;
+        }
+        const Scratch &cumulative = Cumulative();
+        for (size_t shot = 0; shot < shots; ++shot)
+        {
+            double r = engine.UniformDouble();
+            record(SearchCumulative(cumulative, r));        // O(log 2^n) = O(n) lookup
         }
+    }
+    /**
+     * @brief Seed this register's measurement engine for reproducible runs
+     * @param seed User seed
+     * @param stream Stream id (e.g., experiment or thread number)
+     * 
+     * Two registers seeded with the same (seed, stream) and driven through the
+     * same circuit produce identical measurement sequences.
+     */
+    void Seed(uint64_t seed, uint64_t stream = 0)
+    {
+        rng.Seed(seed, stream);
+    }
+    /**
+     * @brief Access the register's random engine
+     * @return Reference to the engine used by Collapse(), MeasureWithoutCollapse() and Sample()
+     * 
+     * Allows plugging in a pre-configured engine: reg.Engine() = Register::RandomEngine(7, 2);
+     */
+    RandomEngine &Engine()
+    {
+        return rng;
+    }
+    /**
+     * @brief Sample the state and write the histogram as CSV for plotter.py
+     * @param shots Number of samples to draw
+     * @param filename Output CSV path (e.g., "collapse_measurements.csv")
+     * @return true if the file was written successfully
+     * 
+     * Output Format (matches plotter.py expectations):
+     * Measurement,Count
+     * 000,4
+     * 001,19
+     * ...
+     * 
+     * Only observed basis states are written, in ascending index order.
+     * 
+     * @complexity Time: O(2^n + shots·n), Space: O(2^n)
+     */
+    bool ExportSampleCSV(size_t shots, const std::string &filename)
+    {
+        std::ofstream file(filename);
+        if (!file)
+            return false;
 
-        // Convert measured state index to binary string
-        // Note: We do NOT modify val[] - state remains unchanged
-        std::string result;
-        for (int j = bits - 1; j >= 0; --j)
+        file << "Measurement,Count\n";
+        for (const auto &[index, count] : Sample(shots))
+        {
+            file << IndexToBitstring(index) << "," << count << "\n";
+        }
+        return static_cast<bool>(file);
+    }
+    /**
+     * @brief Convert a basis state index into its n-bit binary string
+     * @param index Basis state index (0 to 2^n - 1)
+     * @return Binary string of length n, MSB first (same convention as Collapse())
+     * 
+     * Example: For 3 qubits, IndexToBitstring(5) returns "101"
+     * 
+     * @complexity Time: O(n), Space: O(n)
+     */
+    std::string IndexToBitstring(uint64_t index) const
+    {
+        std::string result(bits, '0');
+        for (int j = 0; j < bits; ++j)
         {
-            result += std::to_string((measuredIndex >> j) & 1);
+            if ((index >> j) & 1)
+                result[bits - 1 - j] = '1';                 // Bit j lands at position n-1-j
         }
         return result;
     }
 
 private:
+    using Scratch = std::vector<double, PoolAllocator<double>>;   ///< Pooled measurement scratch
+
+    /**
+     * @brief Size val to size zero amplitudes, written in parallel
+     * 
+     * ResizeUninitialised() leaves the new elements unwritten, so a fresh
+     * block is first touched by the pool workers, chunk by chunk:
+     * on a NUMA machine its pages spread over the workers' nodes, as later
+     * sweeps do, instead of all landing on the constructing thread's node.
+     * Chunks are claimed dynamically, so the placement is interleaved rather
+     * than matched to any one later sweep. A block recycled from the pool
+     * keeps its existing placement.
+     */
+    void ZeroFill(uint64_t size)
+    {
+        ResizeUninitialised(val, size);
+        Amplitude *amp = val.data();
+        ThreadPool::Instance().ParallelFor(size, kAmplitudesPerReduceChunk, [=](uint64_t begin, uint64_t end) {
+            std::fill(amp + begin, amp + end, Amplitude(0, 0));
+        });
+    }
+
+    /**
+     * @brief (-1)^popcount(bits) as a branch-free ±1.0
+     */
+    static double ParitySign(uint64_t bits)
+    {
+        return 1.0 - 2.0 * double(std::bitset<64>(bits).count() & 1);
+    }
+
+    /**
+     * @brief Σ_t weight_t · Σᵢ (-1)^popcount(i & z_t)·|αᵢ|² for diagonal (pure-Z) terms
+     */
+    template <typename Factor>
+    double DiagonalPass(const std::vector<Factor> &factors) const
+    {
+        const Amplitude *amp = val.data();
+        const Factor *f = factors.data();
+        const size_t count = factors.size();
+        return ThreadPool::Instance().ParallelReduce(val.size(), kAmplitudesPerReduceChunk, 0.0,
+            [amp, f, count](uint64_t begin, uint64_t end) {
+                double sum = 0.0;
+                for (uint64_t i = begin; i < end; ++i)
+                {
+                    const double p = double(std::norm(amp[i]));
+                    double eigen = 0.0;
+                    for (size_t t = 0; t < count; ++t)
+                        eigen += ParitySign(i & f[t].zMask) * f[t].weight;
+                    sum += eigen * p;
+                }
+                return sum;
+            });
+    }
+
+    /**
+     * @brief Shared pass for terms with the same non-zero X/Y support xMask
+     * 
+     * Visits each pair (i, i ⊕ xMask) once, with i the member whose lowest
+     * xMask bit is 0, and adds 2·sᵢ·weight·Re(A) (even #Y) or 2·sᵢ·weight·Im(A)
+     * (odd #Y, sign folded into weight) for A = conj(α_{i⊕x})·αᵢ.
+     */
+    template <typename Factor>
+    double PairedPass(uint64_t xMask, const std::vector<Factor> &factors) const
+    {
+        const Amplitude *amp = val.data();
+        const Factor *f = factors.data();
+        const size_t count = factors.size();
+        const uint64_t pivot = xMask & (~xMask + 1);                // Lowest flipped bit
+        const uint64_t low = pivot - 1;
+        return ThreadPool::Instance().ParallelReduce(val.size() / 2, kAmplitudesPerReduceChunk, 0.0,
+            [amp, f, count, xMask, low](uint64_t begin, uint64_t end) {
+                double sum = 0.0;
+                for (uint64_t k = begin; k < end; ++k)
+                {
+                    const uint64_t i = ((k & ~low) << 1) | (k & low);    // Insert 0 at the pivot bit
+                    const std::complex<double> a(amp[i]), b(amp[i ^ xMask]);
+                    const double re = b.real() * a.real() + b.imag() * a.imag();   // conj(b)·a
+                    const double im = b.real() * a.imag() - b.imag() * a.real();
+                    double value = 0.0;
+                    for (size_t t = 0; t < count; ++t)
+                        value += ParitySign(i & f[t].zMask) * f[t].weight * (f[t].imaginary ? im : re);
+                    sum += 2.0 * value;
+                }
+                return sum;
+            });
+    }
+
+    RandomEngine rng = RandomEngine::FromEntropy();  ///< Per-register measurement engine
+
+    /**
+     * @struct StateCache
+     * @brief Lazily built data derived from val, valid until MarkDirty()
+     * 
+     * Const readers (possibly on several threads) build entries under the
+     * mutex; once built they are only read until the next non-const change.
+     * Copies and moves of a register start with a cold cache.
+     */
+    struct StateCache
+    {
+        std::mutex mutex;                        ///< Serialises lazy builds
+        bool normValid = false;
+        double norm = 0.0;                       ///< Σ |αᵢ|²
+        bool blocksValid = false;
+        std::vector<double> blockPrefix;         ///< Running block norms (DrawIndex)
+        bool cumulativeValid = false;
+        Scratch cumulative;                      ///< Running amplitude norms (Sample)
+
+        StateCache() = default;
+        StateCache(const StateCache &) {}
+        StateCache(StateCache &&) noexcept {}
+        StateCache &operator=(const StateCache &) { Invalidate(); return *this; }
+        StateCache &operator=(StateCache &&) noexcept { Invalidate(); return *this; }
+
+        void Invalidate()
+        {
+            normValid = blocksValid = cumulativeValid = false;
+        }
+    };
+    mutable StateCache cache;
+
+    /**
+     * @brief Validated state vector length 2^n for the constructors
+     * @throws std::length_error if the state exceeds the memory budget
+     */
+    static uint64_t StateSize(int n)
+    {
+        CheckMemoryBudget(n, sizeof(Amplitude));
+        return uint64_t(1) << n;
+    }
+    /**
+     * @brief Locate the basis index selected by a uniform draw, without a 2^n table
+     * @param r Uniform random number in [0,1)
+     * @return First index i with Σ_{k ≤ i} |αₖ|² > r·Σₖ|αₖ|²
+     * 
+     * Single draws do not amortise a 2^n cumulative array, so instead:
+     * 1. BlockPrefix(): running sums of the kReduceBlock-sized block norms
+     *    (one parallel pass, then cached while the state is unchanged)
+     * 2. Binary search the block whose running sum passes r·total
+     * 3. Scan that one block amplitude by amplitude
+     * If rounding leaves the target unreached, the last index with non-zero
+     * probability (in that block, or overall) is returned, so a
+     * zero-probability state is never drawn.
+     * 
+     * @complexity Time: O(2^n) for the first draw on a state, then
+     *             O(n + kReduceBlock); Space: O(2^n / kReduceBlock)
+     */
+    uint64_t DrawIndex(double r) const
+    {
+        const Amplitude *amp = val.data();
+        const uint64_t size = val.size();
+        const std::vector<double> &prefix = BlockPrefix();
+        const double target = r * prefix.back();
+
+        uint64_t block = std::upper_bound(prefix.begin(), prefix.end(), target) - prefix.begin();
+        if (block == prefix.size())                         // r·total rounded up to the total
+        {
+            block = prefix.size() - 1;
+            while (block > 0 && prefix[block] == prefix[block - 1])
+                --block;                                    // Last block with non-zero weight
+        }
+        const uint64_t begin = block * kReduceBlock;
+        const uint64_t end = std::min<uint64_t>(begin + kReduceBlock, size);
+        double running = block ? prefix[block - 1] : 0.0;
+        for (uint64_t i = begin; i < end; ++i)
+        {
+            running += double(std::norm(amp[i]));
+            if (running > target)
+                return i;
+        }
+        uint64_t last = end - 1;
+        while (last > begin && std::norm(amp[last]) == 0)
+            --last;
+        return last;
+    }
+    /**
+     * @brief Cached running sums of the block norms: prefix[b] = Σ |αᵢ|² over blocks 0..b
+     * 
+     * Blocks are summed in parallel (SimdNormSum per kReduceBlock amplitudes)
+     * and accumulated in order, so the table is thread-count independent.
+     * The vector keeps its capacity across invalidations, so draws after
+     * the first allocate nothing.
+     */
+    const std::vector<double> &BlockPrefix() const
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        if (!cache.blocksValid)
+        {
+            const uint64_t size = val.size();
+            const uint64_t blocks = (size + kReduceBlock - 1) / kReduceBlock;
+            cache.blockPrefix.resize(blocks);
+            const Amplitude *amp = val.data();
+            double *out = cache.blockPrefix.data();
+            ThreadPool::Instance().ParallelFor(blocks, std::max<uint64_t>(1, kAmplitudesPerReduceChunk / kReduceBlock),
+                [=](uint64_t first, uint64_t last) {
+                    for (uint64_t b = first; b < last; ++b)
+                        out[b] = SimdNormSum(amp + b * kReduceBlock, std::min<uint64_t>(kReduceBlock, size - b * kReduceBlock));
+                });
+            for (uint64_t b = 1; b < blocks; ++b)
+                out[b] += out[b - 1];
+            cache.blocksValid = true;
+        }
+        return cache.blockPrefix;
+    }
+    /**
+     * @brief Cached cumulative Born-rule distribution of the current state
+     * @return Vector c where c[i] = Σ_{k ≤ i} |αₖ|²
+     * 
+     * Used by Sample(), where the table is amortised over many shots (and,
+     * through the cache, over repeated Sample() calls on the same state). The
+     * array is reserved up-front so the 2^n entries are filled without
+     * reallocation; MarkDirty() releases it.
+     * 
+     * @complexity Time: O(2^n) when the cache is cold, Space: O(2^n)
+     */
+    const Scratch &Cumulative() const
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        if (!cache.cumulativeValid)
+        {
+            Scratch cumulative{PoolAllocator<double>(val.get_allocator())};
+            cumulative.reserve(val.size());
+            double total = 0.0;
+            for (const auto &amp : val)
+            {
+                total += double(std::norm(amp));            // Add |αᵢ|² to cumulative sum
+                cumulative.push_back(total);
+            }
+            cache.cumulative.swap(cumulative);
+            cache.cumulativeValid = true;
+        }
+        return cache.cumulative;
+    }
+    /**
+     * @brief Find the basis index selected by a uniform draw
+     * @param cumulative Cumulative distribution from Cumulative()
+     * @param r Uniform random number in [0,1)
+     * @return First index i with cumulative[i] > r·total
+     * 
+     * The draw is scaled by the final cumulative value so rounding drift in
+     * Σ|αᵢ|² never leaves r past the end of the table.
+     * 
+     * @complexity Time: O(n) binary search over 2^n entries, Space: O(1)
+     */
+    static uint64_t SearchCumulative(const Scratch &cumulative, double r)
+    {
+        double target = r * cumulative.back();
+        uint64_t index = std::upper_bound(cumulative.begin(), cumulative.end(), target) - cumulative.begin();
+        return std::min<uint64_t>(index, cumulative.size() - 1);
+    }
+
     /**
      * @brief Normalize the quantum state to ensure probability conservation
      * @return The original magnitude squared sum before normalization
@@ -401,6 +1440,7 @@ private:
      * 1. Calculate total probability: S = Σᵢ |αᵢ|²
      * 2. Divide each amplitude by √S: αᵢ → αᵢ/√S
      * 3. After normalization: Σᵢ |αᵢ/√S|² = S/S = 1
+     * 4. Record the norm as 1, so the next MagnitudeSquareSum() needs no pass
      * 
      * Mathematical Justification:
      * The Born rule requires Σᵢ P(i) = Σᵢ |αᵢ|² = 1 for a valid quantum state.
@@ -411,37 +1451,61 @@ private:
      */
     double Normalise()
     {
-        double magnitudeSquareSum = MagnitudeSquareSum();
-        for (auto &i : val)
-        {
-            i /= sqrt(magnitudeSquareSum);                  // Normalize: αᵢ → αᵢ/√Σⱼ|αⱼ|²
-        }
+        PROFILE_SCOPE("Normalise", -1, val.size(), 3 * val.size() * sizeof(Amplitude));
+        double magnitudeSquareSum = MagnitudeSquareSum();   // Cached if nothing changed since the last pass
+        const T scale = T(1.0 / sqrt(magnitudeSquareSum));
+        Amplitude *amp = val.data();
+        ThreadPool::Instance().ParallelFor(val.size(), kAmplitudesPerReduceChunk, [=](uint64_t begin, uint64_t end) {
+            for (uint64_t i = begin; i < end; ++i)
+                amp[i] *= scale;                            // Normalize: αᵢ → αᵢ/√Σⱼ|αⱼ|²
+        });
+        MarkDirty();
+        cache.norm = 1.0;                                   // Normalised by construction: no pass needed
+        cache.normValid = true;
         return magnitudeSquareSum;
     }
+};
 
-    /**
-     * @brief Ensure random number generator is properly seeded
-     * 
-     * Uses a static variable to ensure the random number generator is
-     * seeded exactly once during program execution. This prevents
-     * predictable random sequences that could occur if srand() is
-     * called multiple times with the same seed.
-     * 
-     * Implementation Details:
-     * - Static lambda ensures single execution
-     * - Seeds with current time for unpredictability
-     * - Thread-safe initialization (C++11 guarantees)
-     * 
-     * Note: For cryptographic applications or high-quality randomness,
-     * consider using std::random_device and std::mt19937 instead of rand().
-     */
-    void EnsureRandomSeeded()
-    {
-        static bool seeded = []
-        {
-            std::srand(static_cast<unsigned>(time(0)));     // Seed with current time
-            return true;
-        }();
-    }
+using Register = BasicRegister<double>;          ///< Double-precision register (default)
+using RegisterF = BasicRegister<float>;          ///< Single-precision register
+
+/**
+ * @enum Precision
+ * @brief Amplitude precision selectable at run time
+ */
+enum class Precision
+{
+    Single,                                      ///< complex<float>, RegisterF
+    Double                                       ///< complex<double>, Register
 };
 
+/**
+ * @brief Register of either precision, chosen at run time
+ * 
+ * Code written once as a generic lambda runs on both:
+ * AnyRegister reg = MakeRegister(30, ChoosePrecision(30));
+ * std::visit([](auto &r) { HadamardR().Apply(r); r.Sample(1000); }, reg);
+ */
+using AnyRegister = std::variant<Register, RegisterF>;
+
+/**
+ * @brief Widest precision whose n-qubit state fits the memory budget
+ * @return Precision::Double if it fits, otherwise Precision::Single
+ */
+inline Precision ChoosePrecision(int n)
+{
+    return RegisterBudget::FitsMemoryBudget(n, sizeof(COMPLEX<double>)) ? Precision::Double : Precision::Single;
+}
+
+/**
+ * @brief Create an n-qubit register in |00...0⟩ with the requested precision
+ * @throws std::length_error if the state exceeds the memory budget
+ */
+inline AnyRegister MakeRegister(int n, Precision precision)
+{
+    if (precision == Precision::Single)
+        return AnyRegister(std::in_place_type<RegisterF>, n);
+    return AnyRegister(std::in_place_type<Register>, n);
+}
+
+#endif // QUANTUM_REGISTERS_CL_CPP
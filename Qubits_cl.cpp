@@ -1,5 +1,8 @@
 #include <iostream>
 #include <complex>
+#include <cstdint>
+
+#include "Random_cl.cpp"
 
 class Qubit {
 public:
@@ -47,15 +50,13 @@ public:
         return std::norm(val[1]);
     }
     int MeasureWithoutCollapse(){
-        EnsureRandomSeeded();
         double prob0 = std::norm(ampliA);
-        double randNum = static_cast<double>(rand()) / RAND_MAX;
+        double randNum = rng.UniformDouble();
         return (randNum < prob0) ? 0 : 1;
     }
     bool Collapse() {
-        EnsureRandomSeeded();
         double prob0 = std::norm(ampliA);
-        double randNum = static_cast<double>(rand()) / RAND_MAX;
+        double randNum = rng.UniformDouble();
     
         if (randNum < prob0) {
             // Collapse to |0⟩
@@ -73,13 +74,14 @@ public:
     std::complex<double> FindInnerProduct(const Qubit& other) const {
         return std::conj(val[0]) * other.val[0] + std::conj(val[1]) * other.val[1];
     }
-    private:
-    void EnsureRandomSeeded() {
-        static bool seeded = [] {
-            std::srand(static_cast<unsigned>(time(0)));
-            return true;
-        }();
+    void Seed(uint64_t seed, uint64_t stream = 0) { //Explicit seed for reproducible measurement sequences
+        rng.Seed(seed, stream);
     }
+    Xoshiro256 &Engine() {
+        return rng;
+    }
+    private:
+    Xoshiro256 rng = Xoshiro256::FromEntropy(); //Per-qubit engine, no shared global rand() state
     void Normalise(){
         double magnitudeSquared = MagnitudeSquareSum();
         val[0] /= sqrt(magnitudeSquared);
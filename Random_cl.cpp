@@ -0,0 +1,150 @@
+/**
+ * @file Random_cl.cpp
+ * @brief Fast, reproducible pseudo-random engine used for quantum measurement
+ *
+ * This file implements the xoshiro256** generator (Blackman & Vigna, 2018),
+ * the engine behind every measurement draw in Qubit and Register.
+ *
+ * Why not rand()?
+ * - rand() is global state: every measurement in the program shares (and
+ *   serialises on) one hidden generator
+ * - RAND_MAX is often 2^31 - 1, so rand()/RAND_MAX resolves ~31 bits; basis
+ *   states with probability below ~1e-9 can never be drawn
+ * - Seeding from time(0) makes runs impossible to reproduce
+ *
+ * Xoshiro256 instead:
+ * - Is a small value type (32 bytes) owned by each register
+ * - Produces doubles with the full 53-bit mantissa resolution
+ * - Is seeded explicitly from a (seed, stream) pair, so runs are bit-reproducible
+ *   and independent threads can each get their own decorrelated stream
+ * - Satisfies UniformRandomBitGenerator, so it plugs into <random> distributions
+ *
+ * @author Your Name
+ * @date 2025
+ */
+
+#ifndef RANDOM_CL_CPP
+#define RANDOM_CL_CPP
+
+#include <cstdint>
+#include <limits>
+#include <random>
+
+/**
+ * @class Xoshiro256
+ * @brief xoshiro256** 64-bit pseudo-random number generator
+ *
+ * State: four 64-bit words, never all zero.
+ * Period: 2^256 - 1
+ *
+ * Seeding:
+ * The 256-bit state is expanded from (seed, stream) with SplitMix64, the
+ * initialiser recommended by the xoshiro authors. Different stream ids give
+ * unrelated starting points, which is what parallel shot loops need:
+ *
+ * Example Usage:
+ * Xoshiro256 rng(42);             // Reproducible stream 0
+ * Xoshiro256 worker(42, 3);       // Same seed, independent stream 3
+ * double r = rng.UniformDouble(); // r ∈ [0,1) with 53-bit resolution
+ */
+class Xoshiro256
+{
+public:
+    using result_type = uint64_t;               ///< Required by UniformRandomBitGenerator
+
+    /**
+     * @brief Construct an engine from an explicit seed and stream id
+     * @param seed User seed (same seed + stream → identical sequence)
+     * @param stream Stream id used to split one seed across threads/registers
+     */
+    explicit Xoshiro256(uint64_t seed = 0x9E3779B97F4A7C15ull, uint64_t stream = 0)
+    {
+        Seed(seed, stream);
+    }
+
+    /**
+     * @brief Re-seed the engine
+     * @param seed User seed
+     * @param stream Stream id
+     *
+     * The stream id is mixed into the SplitMix64 counter with a large odd
+     * multiplier, so neighbouring (seed, stream) pairs start far apart.
+     */
+    void Seed(uint64_t seed, uint64_t stream = 0)
+    {
+        uint64_t sm = seed ^ (stream * 0xD1B54A32D192ED03ull);
+        for (auto &word : s)
+        {
+            word = SplitMix64(sm);
+        }
+    }
+
+    /**
+     * @brief Create an engine seeded from std::random_device
+     * @param stream Stream id mixed into the entropy seed
+     * @return Non-reproducible engine for default construction
+     */
+    static Xoshiro256 FromEntropy(uint64_t stream = 0)
+    {
+        std::random_device rd;
+        uint64_t seed = (static_cast<uint64_t>(rd()) << 32) ^ rd();
+        return Xoshiro256(seed, stream);
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    /**
+     * @brief Advance the state and return the next 64-bit output
+     * @complexity Time: O(1), a handful of shifts, rotates and xors
+     */
+    result_type operator()()
+    {
+        const uint64_t result = Rotl(s[1] * 5, 7) * 9;
+        const uint64_t t = s[1] << 17;
+
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+
+        s[2] ^= t;
+        s[3] = Rotl(s[3], 45);
+
+        return result;
+    }
+
+    /**
+     * @brief Draw a uniform double in [0,1)
+     * @return Top 53 bits of the next output scaled by 2^-53
+     *
+     * Every representable multiple of 2^-53 is reachable, so basis states with
+     * probabilities far below rand()'s 1/RAND_MAX floor are still sampled.
+     */
+    double UniformDouble()
+    {
+        return static_cast<double>((*this)() >> 11) * 0x1.0p-53;
+    }
+
+private:
+    uint64_t s[4];                              ///< Generator state
+
+    static uint64_t Rotl(uint64_t x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    /**
+     * @brief SplitMix64 step used to expand seeds into full state words
+     * @param x Counter, advanced in place
+     */
+    static uint64_t SplitMix64(uint64_t &x)
+    {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+};
+
+#endif // RANDOM_CL_CPP
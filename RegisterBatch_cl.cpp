@@ -0,0 +1,402 @@
+/**
+ * @file RegisterBatch_cl.cpp
+ * @brief B same-width registers in one batch-innermost array, one gate sweep for all of them
+ *
+ * Parameter sweeps and exhaustive oracle checks (DemonstrateAllFunctions in
+ * DeutscheAlgo_example.cpp) simulate many small registers with identical
+ * shape. One Register per case means one tiny std::vector each, a thread-pool
+ * dispatch per gate per case, and kernels whose runs are too short to use the
+ * vector units.
+ *
+ * BasicRegisterBatch<T> stores all B states in a single array with the batch
+ * index innermost:
+ *
+ *     val[i · B + b] = amplitude of basis state |i⟩ in state b
+ *
+ * A gate on qubit q pairs rows i and i | 2^q exactly as in a Register, but each
+ * "amplitude" is now a contiguous row of B amplitudes, so a run of len pairs
+ * becomes two contiguous blocks of len · B amplitudes. Gates shared by every
+ * state reuse the vectorised run kernels of Simd_cl.cpp on those blocks;
+ * per-state matrices (ApplyMatrixEach, ApplyControlledEach) splat one matrix
+ * per lane and vectorise over b. Both are distributed over the thread pool
+ * with chunks of ~kPairsPerChunk amplitude pairs, however small n is.
+ *
+ * Usage:
+ * RegisterBatch batch(10, 256);                        // 256 ten-qubit states in |0...0⟩
+ * batch.ApplyAll(HadamardR());
+ * std::vector<Matrix2> rz(256);                        // One rotation angle per state
+ * for(uint64_t b = 0; b < 256; ++b) rz[b] = Matrix2{{std::polar(1.0, -0.01*b), 0.0, 0.0, std::polar(1.0, 0.01*b)}};
+ * batch.ApplyMatrixEach(3, rz);
+ * std::vector<double> p = batch.ProbabilityOne(3);    // P(qubit 3 = 1) for each state
+ * Register state7 = batch.GetState(7);                 // Unpack one member
+ *
+ * @author Your Name
+ * @date 2025
+ */
+
+#ifndef REGISTER_BATCH_CL_CPP
+#define REGISTER_BATCH_CL_CPP
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "RegisterGates_cl.cpp"
+#include "RegisterSoA_cl.cpp"
+
+/**
+ * @class BasicRegisterBatch
+ * @brief B quantum registers of n qubits stored batch-innermost
+ * @tparam T Amplitude precision (double or float)
+ *
+ * Reductions (MagnitudeSquareSums, ProbabilityOne, MeasureIndex) split the
+ * work over states, so each state's result is summed in a fixed order by a
+ * single thread and does not depend on the thread count.
+ */
+template <typename T>
+class BasicRegisterBatch
+{
+public:
+    using Amplitude = COMPLEX<T>;
+    using Array = std::vector<Amplitude, AlignedAllocator<Amplitude, 64>>;
+    using RandomEngine = Xoshiro256;
+
+    int bits;           ///< Qubits per state
+    uint64_t batch;     ///< Number of states B
+    Array val;          ///< val[i · B + b] = ⟨i|ψ_b⟩
+
+    /**
+     * @brief B registers of n qubits, all in |00...0⟩
+     * @throws std::length_error if B · 2^n amplitudes exceed the memory budget
+     */
+    BasicRegisterBatch(int n, uint64_t states) : bits(n), batch(states), val(CheckedSize(n, states), Amplitude(0, 0))
+    {
+        for (uint64_t b = 0; b < batch; ++b)
+            val[b] = Amplitude(1, 0);
+    }
+
+    /**
+     * @brief Pack existing registers (all of the same width) into a batch
+     */
+    explicit BasicRegisterBatch(const std::vector<BasicRegister<T>> &states)
+        : BasicRegisterBatch(states.empty() ? 0 : states.front().bits, states.size())
+    {
+        for (uint64_t b = 0; b < batch; ++b)
+            SetState(b, states[b]);
+    }
+
+    /**
+     * @brief Basis states per register, 2^n
+     */
+    uint64_t States() const
+    {
+        return uint64_t(1) << bits;
+    }
+
+    /**
+     * @brief Overwrite member b with a register's state
+     */
+    void SetState(uint64_t b, const BasicRegister<T> &reg)
+    {
+        assert(b < batch && reg.bits == bits && "State index out of range or width mismatch");
+        for (uint64_t i = 0; i < States(); ++i)
+            val[i * batch + b] = reg.val[i];
+    }
+
+    /**
+     * @brief Copy member b out into a standalone register
+     * @complexity Time: O(2^n), Space: O(2^n)
+     */
+    BasicRegister<T> GetState(uint64_t b) const
+    {
+        assert(b < batch && "State index out of range");
+        BasicRegister<T> reg(bits);
+        for (uint64_t i = 0; i < States(); ++i)
+            reg.val[i] = val[i * batch + b];
+        reg.MarkDirty();
+        return reg;
+    }
+
+    /**
+     * @brief Amplitude ⟨i|ψ_b⟩
+     */
+    Amplitude GetAmplitude(uint64_t b, uint64_t index) const
+    {
+        return val[index * batch + b];
+    }
+
+    /**
+     * @brief |⟨i|ψ_b⟩|²
+     */
+    double GetProbab(uint64_t b, uint64_t index) const
+    {
+        return std::norm(val[index * batch + b]);
+    }
+
+    /**
+     * @brief Apply a fixed single-qubit gate (HadamardR, XGateR, TGateR, ...) to every state
+     *
+     * Gates are applied through their Matrix(), so any RGates with a 2×2
+     * matrix works.
+     *
+     * @throws std::invalid_argument if the gate has no matrix (controlled gates take the overload below)
+     */
+    void ApplyGate(const RGates &gate, int qubitIndex)
+    {
+        const Matrix2 u = FixedMatrix(gate);
+        PROFILE_SCOPE(gate.Name(), qubitIndex, val.size(), 2 * val.size() * sizeof(Amplitude));
+        ApplyMatrix(qubitIndex, u);
+    }
+
+    /**
+     * @brief Apply a controlled gate (CNotGateR, CZGateR, ToffoliGateR, ...) to every state
+     */
+    void ApplyGate(const ControlledGateR &gate, int qubitIndex)
+    {
+        PROFILE_SCOPE(gate.Name(), qubitIndex, val.size(), 2 * val.size() * sizeof(Amplitude));
+        ApplyControlled(qubitIndex, gate.ControlMask(), gate.TargetMatrix());
+    }
+
+    /**
+     * @brief The gate on each qubit in turn, in every state (batched RGates::Apply)
+     */
+    void ApplyAll(const RGates &gate)
+    {
+        for (int q = 0; q < bits; ++q)
+            ApplyGate(gate, q);
+    }
+
+    /**
+     * @brief Same 2×2 unitary on one qubit of every state
+     * @complexity Time: O(B · 2^n), Space: O(1)
+     */
+    void ApplyMatrix(int qubitIndex, const Matrix2 &u)
+    {
+        ApplyControlled(qubitIndex, 0, u);
+    }
+
+    /**
+     * @brief Same 2×2 unitary on the target of every state where all controls are |1⟩
+     *
+     * Diagonal matrices only scale (the |0⟩ half is skipped when u00 = 1),
+     * exactly as ApplyControlledMatrix2 does for one register.
+     */
+    void ApplyControlled(int targetIndex, uint64_t controlMask, const Matrix2 &u)
+    {
+        const uint64_t tmask = uint64_t(1) << targetIndex;
+        assert(targetIndex < bits && (controlMask >> bits) == 0 && !(controlMask & tmask) && "Invalid target or controls");
+        Amplitude *amp = val.data();
+        const uint64_t partner = tmask * batch;                // Element offset of the target = 1 row
+        if (u.IsDiagonal())
+        {
+            const Amplitude p0(u.m[0]), p1(u.m[3]);
+            const bool touchZero = std::abs(u.m[0] - 1.0) > 1e-15;
+            ForEachBatchRun(controlMask | tmask, controlMask, [=](uint64_t offset, uint64_t len) {
+                if (touchZero)
+                    SimdPhaseRun(amp + offset, len, p0);
+                SimdPhaseRun(amp + offset + partner, len, p1);
+            });
+            return;
+        }
+        Amplitude um[4];
+        u.To(um);
+        ForEachBatchRun(controlMask | tmask, controlMask, [=, &um](uint64_t offset, uint64_t len) {
+            SimdMatrix2Run(amp + offset, amp + offset + partner, len, um);
+        });
+    }
+
+    /**
+     * @brief A different 2×2 unitary on one qubit of each state (parameter sweeps)
+     * @param perState B matrices; perState[b] acts on state b
+     */
+    void ApplyMatrixEach(int qubitIndex, const std::vector<Matrix2> &perState)
+    {
+        ApplyControlledEach(qubitIndex, 0, perState);
+    }
+
+    /**
+     * @brief A different controlled 2×2 unitary in each state (same target and controls)
+     * @param perState B matrices; perState[b] acts on state b's control-satisfied subspace
+     *
+     * The matrices are split into per-entry real/imaginary lane arrays, so
+     * the inner loop over b is plain element-wise arithmetic that vectorises.
+     */
+    void ApplyControlledEach(int targetIndex, uint64_t controlMask, const std::vector<Matrix2> &perState)
+    {
+        const uint64_t tmask = uint64_t(1) << targetIndex;
+        assert(perState.size() == batch && "One matrix per state");
+        assert(targetIndex < bits && (controlMask >> bits) == 0 && !(controlMask & tmask) && "Invalid target or controls");
+
+        std::vector<T> lanes(8 * batch);                       // uRe[e][b], uIm[e][b] for e = 0..3
+        for (uint64_t b = 0; b < batch; ++b)
+        {
+            for (int e = 0; e < 4; ++e)
+            {
+                lanes[(2 * e) * batch + b] = T(perState[b].m[e].real());
+                lanes[(2 * e + 1) * batch + b] = T(perState[b].m[e].imag());
+            }
+        }
+        const T *u = lanes.data();
+        const uint64_t B = batch;
+        T *amp = reinterpret_cast<T *>(val.data());
+        const uint64_t partner = 2 * tmask * batch;            // In scalars
+        ForEachBatchRun(controlMask | tmask, controlMask, [=](uint64_t offset, uint64_t len) {
+            for (uint64_t row = 0; row < len; row += B)
+            {
+                T *__restrict a = amp + 2 * (offset + row);
+                T *__restrict c = a + partner;
+                const T *__restrict u00r = u, *__restrict u00i = u + B, *__restrict u01r = u + 2 * B, *__restrict u01i = u + 3 * B;
+                const T *__restrict u10r = u + 4 * B, *__restrict u10i = u + 5 * B, *__restrict u11r = u + 6 * B, *__restrict u11i = u + 7 * B;
+                for (uint64_t b = 0; b < B; ++b)
+                {
+                    const T xr = a[2 * b], xi = a[2 * b + 1], yr = c[2 * b], yi = c[2 * b + 1];
+                    a[2 * b] = u00r[b] * xr - u00i[b] * xi + u01r[b] * yr - u01i[b] * yi;
+                    a[2 * b + 1] = u00r[b] * xi + u00i[b] * xr + u01r[b] * yi + u01i[b] * yr;
+                    c[2 * b] = u10r[b] * xr - u10i[b] * xi + u11r[b] * yr - u11i[b] * yi;
+                    c[2 * b + 1] = u10r[b] * xi + u10i[b] * xr + u11r[b] * yi + u11i[b] * yr;
+                }
+            }
+        });
+    }
+
+    /**
+     * @brief Σᵢ |⟨i|ψ_b⟩|² for every state b
+     */
+    std::vector<double> MagnitudeSquareSums() const
+    {
+        return LaneSums(0, 0);
+    }
+
+    /**
+     * @brief P(qubit q = 1) for every state (unnormalised states: the raw weight)
+     */
+    std::vector<double> ProbabilityOne(int qubitIndex) const
+    {
+        const uint64_t mask = uint64_t(1) << qubitIndex;
+        return LaneSums(mask, mask);
+    }
+
+    /**
+     * @brief Non-collapsing measurement of every state
+     * @return B sampled basis indices, entry b drawn from |⟨i|ψ_b⟩|² / Σ|⟨k|ψ_b⟩|²
+     *
+     * The B uniforms are drawn from the batch engine in state order, then
+     * each group of states walks the rows once with a running sum per state.
+     *
+     * @complexity Time: O(B · 2^n), Space: O(B)
+     */
+    std::vector<uint64_t> MeasureIndex()
+    {
+        std::vector<double> target = MagnitudeSquareSums();
+        for (double &t : target)
+            t *= rng.UniformDouble();
+        std::vector<uint64_t> outcome(batch, 0);
+        const Amplitude *amp = val.data();
+        const uint64_t B = batch, size = States();
+        double *goal = target.data();
+        uint64_t *out = outcome.data();
+        ThreadPool::Instance().ParallelFor(batch, kStatesPerChunk, [=](uint64_t begin, uint64_t end) {
+            std::vector<double> running(end - begin, 0.0);
+            uint64_t open = end - begin;                        // States still searching
+            for (uint64_t i = 0; i < size && open; ++i)
+            {
+                const Amplitude *row = amp + i * B;
+                for (uint64_t b = begin; b < end; ++b)
+                {
+                    const double p = std::norm(row[b]);
+                    double &sum = running[b - begin];
+                    if (sum > goal[b])
+                        continue;                               // Already resolved
+                    if (p > 0.0)
+                        out[b] = i;                             // Fallback: last non-zero index
+                    sum += p;
+                    if (sum > goal[b])
+                        --open;
+                }
+            }
+        });
+        return outcome;
+    }
+
+    /**
+     * @brief Seed the batch's measurement engine (one draw per state per MeasureIndex)
+     */
+    void Seed(uint64_t seed, uint64_t stream = 0)
+    {
+        rng.Seed(seed, stream);
+    }
+
+private:
+    /// States per reduction task; a multiple of 8 keeps tasks on separate cache lines
+    static constexpr uint64_t kStatesPerChunk = 64;
+
+    RandomEngine rng = RandomEngine::FromEntropy();
+
+    static uint64_t CheckedSize(int n, uint64_t states)
+    {
+        assert(states >= 1 && "A batch holds at least one state");
+        RegisterBudget::CheckMemoryBudget(n, states * sizeof(Amplitude));
+        return (uint64_t(1) << n) * states;
+    }
+
+    /**
+     * @brief Visit the rows whose pinned bits equal setMask as contiguous element runs, in parallel
+     * @param run Callable run(offset, len) over elements val[offset, offset + len)
+     *
+     * Same enumeration as ForEachSubspaceRun on the 2^n row indices, with
+     * every row widened to B elements. Chunks hold ~kPairsPerChunk elements,
+     * so small registers with large batches still spread over the pool.
+     */
+    template <typename F>
+    void ForEachBatchRun(uint64_t pinnedMask, uint64_t setMask, F &&run) const
+    {
+        int pinned[64];
+        int count = 0;
+        for (int b = 0; b < bits; ++b)
+        {
+            if ((pinnedMask >> b) & 1)
+                pinned[count++] = b;
+        }
+        const uint64_t runMask = uint64_t(1) << pinned[0];
+        const uint64_t B = batch;
+        const uint64_t chunk = std::max<uint64_t>(1, kPairsPerChunk / B);
+        ThreadPool::Instance().ParallelFor(States() >> count, chunk, [&](uint64_t begin, uint64_t end) {
+            for (uint64_t k = begin; k < end;)
+            {
+                const uint64_t len = std::min(end - k, runMask - (k & (runMask - 1)));
+                uint64_t index = k;
+                for (int b = 0; b < count; ++b)
+                    index = InsertZeroBit(index, pinned[b]);
+                run((index | setMask) * B, len * B);
+                k += len;
+            }
+        });
+    }
+
+    /**
+     * @brief Per-state Σ |⟨i|ψ_b⟩|² over the rows i with (i & mask) == value
+     */
+    std::vector<double> LaneSums(uint64_t mask, uint64_t value) const
+    {
+        std::vector<double> sums(batch, 0.0);
+        const Amplitude *amp = val.data();
+        const uint64_t B = batch, size = States();
+        double *out = sums.data();
+        ThreadPool::Instance().ParallelFor(batch, kStatesPerChunk, [=](uint64_t begin, uint64_t end) {
+            for (uint64_t i = 0; i < size; ++i)
+            {
+                if ((i & mask) != value)
+                    continue;
+                const Amplitude *row = amp + i * B;
+                for (uint64_t b = begin; b < end; ++b)
+                    out[b] += double(std::norm(row[b]));
+            }
+        });
+        return sums;
+    }
+};
+
+using RegisterBatch = BasicRegisterBatch<double>;         ///< Double-precision batch
+using RegisterBatchF = BasicRegisterBatch<float>;         ///< Single-precision batch
+
+#endif // REGISTER_BATCH_CL_CPP
@@ -5,6 +5,38 @@
  * This file implements quantum gate operations on quantum registers, including:
  * - Hadamard gates for creating superposition states
  * - Pauli-X gates for qubit flipping operations
+ * - Pauli-Y, Pauli-Z, S and T gates (phase gates touch only the |1⟩ half)
+ * - Arbitrary 2×2 unitaries, optionally controlled (CNOT, CZ, Toffoli, C-U)
+ * 
+ * Precision:
+ * Every kernel is a template over the amplitude scalar T and runs on both
+ * Register (double) and RegisterF (float). RGates declares one virtual
+ * ApplyToSingle/Apply per precision; concrete gates derive from
+ * RGateKernels<Gate>, which forwards both to the gate's templated Kernel().
+ * 
+ * Spans:
+ * The kernels behind Execute-able operations (H, X, Y, 2×2, controlled,
+ * tensor block, qubit swap) also accept a raw amplitude span (amp, size) in
+ * place of a register. The cache-blocked executor (Circuit_cl.cpp) uses this
+ * to run several gates on one L2-sized slice of the state before moving on.
+ * 
+ * Permutations:
+ * ApplyQubitPermutation() reorders qubits in place as a sequence of qubit
+ * swaps, tiling the ones below kCacheLocalQubits so they share one sweep;
+ * ApplyIndexPermutation() applies a classical reversible function given as
+ * a lookup table (|i⟩ → |table[i]⟩), scattering into a second buffer in
+ * parallel when the budget allows and following its cycles otherwise.
+ * 
+ * Small registers:
+ * Up to kStaticGateMaxQubits qubits, H, X, Y, Z, S and T on a register
+ * dispatch to the compile-time specialised kernels of StaticGates_cl.cpp,
+ * where the pair loops are unrolled and no pool or run machinery is involved.
+ * 
+ * Parallel Execution:
+ * Kernels iterate directly over the 2^(n-1) amplitude pairs of the target
+ * qubit (no branch-and-skip over all 2^n indices) and hand the pair range to
+ * ThreadPool::ParallelFor in cache-sized chunks. Thread count is configured
+ * via ThreadPool::Instance().SetThreadCount(n).
  * 
  * The implementation uses a state vector representation where a quantum register
  * with n qubits is represented by a vector of 2^n complex amplitudes.
@@ -18,14 +50,187 @@
  * @date 2025
  */
 
+#ifndef REGISTER_GATES_CL_CPP
+#define REGISTER_GATES_CL_CPP
+
 #include <iostream>
 #include <complex>
 #include <cmath>
 #include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <optional>
+#include <cassert>
+#include <bitset>
+#include <stdexcept>
+#include <string>
 
 #include "Quantum_registers_cl.cpp"
+#include "Parallel_cl.cpp"
+#include "Simd_cl.cpp"
+#include "Profile_cl.cpp"
+#include "StaticGates_cl.cpp"
 
 #define COMPLEX std::complex
+
+/// Amplitude pairs per parallel work item: 2 × 8192 × 16 B = 256 KiB, about one L2 cache
+constexpr uint64_t kPairsPerChunk = uint64_t(1) << 13;
+/// Default local qubits per cache block: 2^14 amplitudes × 16 B = 256 KiB, about one L2 cache
+constexpr int kCacheLocalQubits = 14;
+
+/**
+ * @brief Map a pair counter k ∈ [0, 2^(n-1)) to the index with target bit cleared
+ * @param k Pair counter
+ * @param qubitIndex Target qubit (bit position)
+ * @return Index i with bit qubitIndex = 0; its partner is i | (1 << qubitIndex)
+ * 
+ * Inserts a zero bit at position qubitIndex:
+ * k = ...abc|def  (split at qubitIndex = 3)
+ * i = ...abc 0 def
+ * 
+ * This enumerates every amplitude pair exactly once without testing and
+ * skipping half the indices.
+ */
+inline uint64_t InsertZeroBit(uint64_t k, int qubitIndex)
+{
+    uint64_t lowMask = (uint64_t(1) << qubitIndex) - 1;
+    return ((k & ~lowMask) << 1) | (k & lowMask);
+}
+
+/**
+ * @brief Visit every amplitude pair of a qubit as contiguous runs, in parallel
+ * @param size State vector length (2^n)
+ * @param qubitIndex Target qubit
+ * @param run Callable run(i, len): indices i..i+len-1 have target bit 0 and
+ *            their partners are the same range shifted by 1 << qubitIndex
+ * 
+ * For qubitIndex = q a run is at most 2^q long (one block of the 0-half), and
+ * chunk boundaries from the thread pool may split a run. Runs of length ≥ 2
+ * let the SIMD kernels load several amplitudes per instruction; for the
+ * lowest qubits, whose runs are shorter than a register, use ForEachPairOp.
+ */
+template <typename F>
+inline void ForEachPairRun(uint64_t size, int qubitIndex, F &&run)
+{
+    const uint64_t mask = uint64_t(1) << qubitIndex;
+    ThreadPool::Instance().ParallelFor(size / 2, kPairsPerChunk, [&](uint64_t begin, uint64_t end){
+        for(uint64_t k = begin; k < end;){
+            uint64_t len = std::min(end - k, mask - (k & (mask - 1))); // Stay inside one 2^q block
+            run(InsertZeroBit(k, qubitIndex), len);
+            k += len;
+        }
+    });
+}
+/**
+ * @brief Apply a SIMD pair operation (SimdHadamardOp, SimdMatrix2Op, ...) to every pair of a qubit, in parallel
+ * @param amp, size State vector span of 2^k amplitudes
+ * @param qubitIndex Target qubit
+ * @param op Pair operation, called as op(Backend(), a, b)
+ * 
+ * Qubits whose runs are shorter than one SIMD register (q = 0 for
+ * complex<double> on AVX-512, q ≤ 1 for complex<float>, ...) are processed
+ * in place over contiguous chunks: SimdLowPairRun loads whole registers and
+ * separates the partners with a lane permute, instead of one scalar pair per
+ * run. Higher qubits go through ForEachPairRun and SimdPairRun.
+ */
+template <typename T, typename Op>
+inline void ForEachPairOp(COMPLEX<T>* amp, uint64_t size, int qubitIndex, const Op& op)
+{
+    if(qubitIndex <= SimdLowQubitLimit<T>()){
+        // Chunks of 2·kPairsPerChunk amplitudes always hold whole 2^(q+1) blocks
+        ThreadPool::Instance().ParallelFor(size, 2 * kPairsPerChunk, [=, &op](uint64_t begin, uint64_t end){
+            SimdLowPairRun(amp + begin, end - begin, qubitIndex, op);
+        });
+        return;
+    }
+    const uint64_t mask = uint64_t(1) << qubitIndex;
+    ForEachPairRun(size, qubitIndex, [=, &op](uint64_t i, uint64_t len){
+        SimdPairRun(amp + i, amp + (i | mask), len, op);
+    });
+}
+/**
+ * @brief Visit the subspace with some bits pinned, as contiguous runs, in parallel
+ * @param size State vector length (2^n)
+ * @param pinnedMask Bits excluded from enumeration (e.g., controls ∪ target)
+ * @param setMask Subset of pinnedMask forced to 1 in every visited index (e.g., controls)
+ * @param run Callable run(i, len) over indices i..i+len-1
+ * 
+ * Enumerates the 2^(n-p) indices (p = popcount(pinnedMask)) whose pinned bits
+ * equal setMask by inserting a zero at each pinned position. Runs stop at the
+ * lowest pinned bit, so they stay contiguous for the SIMD kernels. With
+ * pinnedMask = 1 << q and setMask = 0 this is exactly ForEachPairRun.
+ */
+template <typename F>
+inline void ForEachSubspaceRun(uint64_t size, uint64_t pinnedMask, uint64_t setMask, F &&run)
+{
+    int pinned[64];
+    int count = 0;
+    for(int b = 0; b < 64; ++b){
+        if((pinnedMask >> b) & 1) pinned[count++] = b;
+    }
+    if(count == 0){
+        ThreadPool::Instance().ParallelFor(size, kPairsPerChunk, [&](uint64_t begin, uint64_t end){ run(begin, end - begin); });
+        return;
+    }
+
+    const uint64_t runMask = uint64_t(1) << pinned[0];
+    ThreadPool::Instance().ParallelFor(size >> count, kPairsPerChunk, [&](uint64_t begin, uint64_t end){
+        for(uint64_t k = begin; k < end;){
+            uint64_t len = std::min(end - k, runMask - (k & (runMask - 1)));
+            uint64_t index = k;
+            for(int b = 0; b < count; ++b) index = InsertZeroBit(index, pinned[b]); // Ascending positions
+            run(index | setMask, len);
+            k += len;
+        }
+    });
+}
+/**
+ * @struct Matrix2
+ * @brief 2×2 complex matrix describing a single-qubit gate
+ * 
+ * Layout (row-major): m = {u00, u01, u10, u11}
+ * | u00 u01 |   acting on   | α (qubit = 0) |
+ * | u10 u11 |               | β (qubit = 1) |
+ * 
+ * Products follow circuit order reversed: applying A then B is the matrix B·A.
+ */
+struct Matrix2{
+    COMPLEX<double> m[4];                    ///< Row-major entries {u00, u01, u10, u11}
+
+    static Matrix2 Identity(){
+        return {{1.0, 0.0, 0.0, 1.0}};
+    }
+
+    /**
+     * @brief Matrix product (this · rhs)
+     */
+    Matrix2 operator*(const Matrix2& rhs) const{
+        return {{m[0]*rhs.m[0] + m[1]*rhs.m[2], m[0]*rhs.m[1] + m[1]*rhs.m[3],
+                 m[2]*rhs.m[0] + m[3]*rhs.m[2], m[2]*rhs.m[1] + m[3]*rhs.m[3]}};
+    }
+
+    /**
+     * @brief True when the off-diagonal entries vanish (phase-only gate)
+     */
+    bool IsDiagonal(double tol = 1e-12) const{
+        return std::abs(m[1]) < tol && std::abs(m[2]) < tol;
+    }
+
+    /**
+     * @brief True when the matrix is the identity up to tolerance
+     */
+    bool IsIdentity(double tol = 1e-12) const{
+        return IsDiagonal(tol) && std::abs(m[0] - 1.0) < tol && std::abs(m[3] - 1.0) < tol;
+    }
+
+    /**
+     * @brief Entries rounded to the register's amplitude type (once per gate, not per run)
+     */
+    template <typename T>
+    void To(COMPLEX<T> (&out)[4]) const{
+        for(int e = 0; e < 4; ++e) out[e] = COMPLEX<T>(m[e]);
+    }
+};
 /**
  * @class RGates
  * @brief Abstract base class for quantum gate operations on registers
@@ -49,6 +254,7 @@ public:
      * For example, applying Hadamard to all qubits creates maximum superposition.
      */
     virtual void Apply(Register& reg) const = 0;
+    virtual void Apply(RegisterF& reg) const = 0;
     
     /**
      * @brief Apply the quantum gate to a specific qubit
@@ -59,12 +265,93 @@ public:
      * leaving other qubits unchanged. Essential for controlled operations.
      */
     virtual void ApplyToSingle(Register& reg, int qubitIndex) const = 0;
+    virtual void ApplyToSingle(RegisterF& reg, int qubitIndex) const = 0;
+
+    /**
+     * @brief 2×2 matrix of this gate, if it is a fixed single-qubit unitary
+     * @return The gate matrix, or std::nullopt for gates without one
+     * 
+     * Used by the fusion stage (GateFusion_cl.cpp) to multiply consecutive
+     * gates into a single sweep. Gates that are not plain 2×2 unitaries
+     * keep the default.
+     */
+    virtual std::optional<Matrix2> Matrix() const { return std::nullopt; }
+
+    /**
+     * @brief Short gate name, used as the operation label by the profiler (Profile_cl.cpp)
+     */
+    virtual const char* Name() const { return "Gate"; }
     
     /**
      * @brief Virtual destructor for proper cleanup of derived classes
      */
     virtual ~RGates() = default;
 };
+/**
+ * @brief The gate's 2×2 matrix, for paths that apply gates only as fixed single-qubit unitaries
+ * @param gate Register gate (H, X, Y, Z, S, T, MatrixGateR, ...)
+ * @return gate.Matrix()
+ * @throws std::invalid_argument if the gate has no matrix (controlled gates take their own overloads)
+ */
+inline Matrix2 FixedMatrix(const RGates& gate){
+    std::optional<Matrix2> u = gate.Matrix();
+    if(!u){
+        throw std::invalid_argument(std::string(gate.Name()) + " gate has no fixed 2x2 matrix");
+    }
+    return *u;
+}
+/**
+ * @class RGateKernels
+ * @brief CRTP bridge from the per-precision virtual interface to one templated kernel
+ * @tparam Gate Concrete gate providing template <typename T> Kernel(BasicRegister<T>&, int)
+ * 
+ * Gates may also provide KernelAll(BasicRegister<T>&) to override the default
+ * "every qubit in turn" behaviour of Apply(), and AmplitudesTouched(size) when
+ * a kernel reads and writes fewer than all 2^n amplitudes (the profiler's
+ * traffic estimate; each touched amplitude is read once and written once).
+ */
+template <typename Gate>
+class RGateKernels : public RGates{
+public:
+    void ApplyToSingle(Register& reg, int qubitIndex) const override { Single(reg, qubitIndex); }
+    void ApplyToSingle(RegisterF& reg, int qubitIndex) const override { Single(reg, qubitIndex); }
+    void Apply(Register& reg) const override { All(reg); }
+    void Apply(RegisterF& reg) const override { All(reg); }
+
+    /**
+     * @brief Default Apply(): the gate on each qubit sequentially
+     */
+    template <typename T>
+    void KernelAll(BasicRegister<T>& reg) const{
+        for(int i = 0; i < reg.bits; ++i){
+            Self().Kernel(reg, i);
+        }
+    }
+
+    /**
+     * @brief Default traffic estimate: the kernel touches every amplitude
+     */
+    uint64_t AmplitudesTouched(uint64_t size) const { return size; }
+
+private:
+    const Gate& Self() const { return static_cast<const Gate&>(*this); }
+
+    template <typename T>
+    void Single(BasicRegister<T>& reg, int qubitIndex) const{
+        PROFILE_SCOPE(Self().Name(), qubitIndex, Self().AmplitudesTouched(reg.val.size()),
+                      2 * Self().AmplitudesTouched(reg.val.size()) * sizeof(COMPLEX<T>));
+        Self().Kernel(reg, qubitIndex);
+        reg.MarkDirty(true);                    // Unitary: the norm survives
+    }
+
+    template <typename T>
+    void All(BasicRegister<T>& reg) const{
+        PROFILE_SCOPE(Self().Name(), -1, Self().AmplitudesTouched(reg.val.size()) * reg.bits,
+                      2 * Self().AmplitudesTouched(reg.val.size()) * reg.bits * sizeof(COMPLEX<T>));
+        Self().KernelAll(reg);
+        reg.MarkDirty(true);
+    }
+};
 /**
  * @class HadamardR
  * @brief Implementation of the Hadamard quantum gate for registers
@@ -83,7 +370,7 @@ public:
  * - Essential for quantum algorithms (Deutsch, Grover, etc.)
  * - Creates quantum parallelism when applied to multiple qubits
  */
-class HadamardR : public RGates{
+class HadamardR : public RGateKernels<HadamardR>{
 public:
     /**
      * @brief Apply Hadamard gate to a specific qubit in the register
@@ -92,7 +379,8 @@ public:
      * 
      * Algorithm:
      * 1. Create bitmask to identify target qubit position
-     * 2. For each pair of states that differ only in target qubit:
+     * 2. For each pair of states that differ only in target qubit
+     *    (enumerated as contiguous runs via ForEachPairRun, in parallel chunks):
      *    - Extract amplitudes a (qubit=0) and b (qubit=1)
      *    - Apply transformation: new_a = (a+b)/√2, new_b = (a-b)/√2
      * 3. Update register with transformed amplitudes
@@ -100,47 +388,30 @@ public:
      * Time Complexity: O(2^n) where n is number of qubits
      * Space Complexity: O(1) additional space
      */
-    void ApplyToSingle(Register& reg, int qubitIndex) const override{
-        int size = reg.val.size();           // Total number of quantum states (2^n)
-        int mask = 1 << qubitIndex;          // Bitmask for target qubit position
-
-        // Iterate through all quantum states
-        for(int i = 0; i < size; ++i){
-            // Process only states where target qubit is 0 (to avoid double processing)
-            if(!(i&mask)){
-                int j = i | mask;            // Corresponding state with target qubit = 1
-
-                // Extract current amplitudes for the state pair
-                COMPLEX<double> a = reg.val[i];  // Amplitude when target qubit = 0
-                COMPLEX<double> b = reg.val[j];  // Amplitude when target qubit = 1
-                
-                // Hadamard transformation matrix normalization factor
-                const double invSqrt2 = 1.0f/std::sqrt(2.0f);
-                
-                // Apply Hadamard transformation
-                reg.val[i] = (a+b)*invSqrt2;     // New amplitude for |...0...⟩
-                reg.val[j] = (a-b)*invSqrt2;     // New amplitude for |...1...⟩
-            }
-        }
+    template <typename T>
+    void Kernel(BasicRegister<T>& reg, int qubitIndex) const{
+        if(!ApplyStaticSmall<StaticHadamard>(reg.val.data(), reg.bits, qubitIndex)) // Small n: unrolled kernel
+            KernelSpan(reg.val.data(), reg.val.size(), qubitIndex);
     }
-    
+
     /**
-     * @brief Apply Hadamard gate to all qubits in the register
-     * @param reg Reference to the quantum register
-     * 
-     * Creates maximum superposition state where all 2^n basis states have
-     * equal probability amplitudes. For n qubits, each state gets amplitude 1/√(2^n).
-     * 
-     * Example: 2-qubit register |00⟩ becomes (|00⟩ + |01⟩ + |10⟩ + |11⟩)/2
+     * @brief Hadamard on a raw amplitude span of 2^k entries (qubitIndex < k)
      */
-    void Apply(Register& reg) const override {
-        int numQubits = reg.bits;            // Get number of qubits in register
-        
-        // Apply Hadamard to each qubit sequentially
-        for(int i = 0; i < numQubits; ++i) {
-            ApplyToSingle(reg, i);           // Transform qubit i
-        }
+    template <typename T>
+    void KernelSpan(COMPLEX<T>* amp, uint64_t size, int qubitIndex) const{
+        // Hadamard transformation matrix normalization factor (hoisted out of the loop)
+        const T invSqrt2 = T(1.0/std::sqrt(2.0));
+
+        // Each pair: a has target qubit = 0, b = a with the target bit set
+        ForEachPairOp(amp, size, qubitIndex, SimdHadamardOp<T>{invSqrt2}); // (a+b)/√2, (a-b)/√2
+    }
+    
+    std::optional<Matrix2> Matrix() const override{
+        const double s = 1.0/std::sqrt(2.0);
+        return Matrix2{{s, s, s, -s}};
     }
+
+    const char* Name() const override { return "H"; }
 };
 /**
  * @class XGateR
@@ -161,7 +432,7 @@ public:
  * - Fundamental building block for quantum circuits
  * - Part of Pauli group {I, X, Y, Z}
  */
-class XGateR : public RGates {
+class XGateR : public RGateKernels<XGateR> {
     public:
         /**
          * @brief Apply Pauli-X gate to a specific qubit in the register
@@ -170,9 +441,8 @@ class XGateR : public RGates {
          * 
          * Algorithm:
          * 1. Create bitmask to identify target qubit position
-         * 2. For each quantum state, find its bit-flipped partner
-         * 3. Swap amplitudes between paired states
-         * 4. Process each pair only once to avoid double-swapping
+         * 2. Enumerate each (target=0, target=1) pair once via ForEachPairRun
+         * 3. Swap amplitudes between paired states (pairs split across threads)
          * 
          * Example: For qubit 0 in 2-qubit system:
          * |00⟩ ↔ |01⟩, |10⟩ ↔ |11⟩
@@ -180,40 +450,610 @@ class XGateR : public RGates {
          * Time Complexity: O(2^n) where n is number of qubits
          * Space Complexity: O(1) additional space
          */
-        void ApplyToSingle(Register& reg, int qubitIndex) const override {
-            int size = reg.val.size();           // Total number of quantum states
-            int mask = 1 << qubitIndex;          // Bitmask for target qubit
-            
-            // Iterate through all quantum states
-            for(int i = 0; i < size; ++i){
-                int j = i ^ mask;                // XOR to flip target qubit bit
-                
-                // Swap amplitudes only once per pair (avoid double-swapping)
-                if(i < j){
-                    std::swap(reg.val[i], reg.val[j]);
-                }
-            }
+        template <typename T>
+        void Kernel(BasicRegister<T>& reg, int qubitIndex) const {
+            if(!ApplyStaticSmall<StaticPauliX>(reg.val.data(), reg.bits, qubitIndex))
+                KernelSpan(reg.val.data(), reg.val.size(), qubitIndex);
+        }
+
+        /**
+         * @brief Pauli-X on a raw amplitude span of 2^k entries (qubitIndex < k)
+         */
+        template <typename T>
+        void KernelSpan(COMPLEX<T>* amp, uint64_t size, int qubitIndex) const {
+            // Each pair is visited exactly once, so no i < j check is needed
+            ForEachPairOp(amp, size, qubitIndex, SimdSwapOp()); // Swap with bit-flipped partners
         }
         
+        std::optional<Matrix2> Matrix() const override {
+            return Matrix2{{0.0, 1.0, 1.0, 0.0}};
+        }
+
+        const char* Name() const override { return "X"; }
+};
+
+/**
+ * @class YGateR
+ * @brief Implementation of the Pauli-Y quantum gate for registers
+ * 
+ * Y = |0 -i|
+ *     |i  0|
+ * 
+ * Transformations:
+ * |0⟩ → i|1⟩
+ * |1⟩ → -i|0⟩
+ * 
+ * Physical Meaning:
+ * - Rotates qubit state by π around Y-axis on Bloch sphere
+ * - Combines a bit flip with a phase flip (Y = iXZ)
+ */
+class YGateR : public RGateKernels<YGateR> {
+    public:
         /**
-         * @brief Apply Pauli-X gate to all qubits in the register
+         * @brief Apply Pauli-Y gate to a specific qubit in the register
          * @param reg Reference to the quantum register
+         * @param qubitIndex Index of the target qubit (0-based)
          * 
-         * Flips all qubits in the register simultaneously.
-         * Example: |000⟩ → |111⟩, |101⟩ → |010⟩
+         * For each pair (a, b): new_a = -i·b, new_b = i·a
          * 
-         * Note: Applying X to all qubits is equivalent to applying
-         * the tensor product X⊗X⊗...⊗X
+         * Time Complexity: O(2^n), Space Complexity: O(1)
+         */
+        template <typename T>
+        void Kernel(BasicRegister<T>& reg, int qubitIndex) const {
+            if(!ApplyStaticSmall<StaticPauliY>(reg.val.data(), reg.bits, qubitIndex))
+                KernelSpan(reg.val.data(), reg.val.size(), qubitIndex);
+        }
+
+        /**
+         * @brief Pauli-Y on a raw amplitude span of 2^k entries (qubitIndex < k)
          */
-        void Apply(Register& reg) const override {
-            int numQubits = reg.bits;            // Get number of qubits
-            
-            // Apply X gate to each qubit sequentially
-            for(int i = 0; i < numQubits; ++i){
-                ApplyToSingle(reg, i);           // Flip qubit i
+        template <typename T>
+        void KernelSpan(COMPLEX<T>* amp, uint64_t size, int qubitIndex) const {
+            ForEachPairOp(amp, size, qubitIndex, SimdPauliYOp());
+        }
+
+        std::optional<Matrix2> Matrix() const override {
+            return Matrix2{{0.0, COMPLEX<double>(0.0, -1.0), COMPLEX<double>(0.0, 1.0), 0.0}};
+        }
+
+        const char* Name() const override { return "Y"; }
+};
+/**
+ * @class PhaseGateR
+ * @brief Diagonal gate diag(1, e^(iφ)) applied to register qubits
+ * 
+ * Shared implementation of the Z, S and T register gates. A diagonal gate
+ * leaves every |...0...⟩ amplitude unchanged, so only the 2^(n-1) amplitudes
+ * with the target qubit set are read and written — half the memory traffic
+ * of a general 2×2 butterfly.
+ * 
+ * Matrix Representation:
+ * P(φ) = |1    0   |
+ *        |0  e^(iφ)|
+ */
+class PhaseGateR : public RGateKernels<PhaseGateR> {
+    public:
+        /**
+         * @brief Construct a phase gate with the given |1⟩ phase factor
+         * @param phaseFactor e^(iφ) multiplying the |1⟩ amplitude
+         * @param gateName Name reported by Name() (Z, S and T pass their own)
+         */
+        explicit PhaseGateR(COMPLEX<double> phaseFactor, const char* gateName = "Phase") : phase(phaseFactor), name(gateName) {}
+
+        /**
+         * @brief Multiply every amplitude with target qubit = 1 by the phase
+         * @param reg Reference to the quantum register
+         * @param qubitIndex Index of the target qubit (0-based)
+         * 
+         * Time Complexity: O(2^(n-1)) amplitudes touched, Space Complexity: O(1)
+         */
+        template <typename T>
+        void Kernel(BasicRegister<T>& reg, int qubitIndex) const {
+            if(KernelStaticSmall(reg, qubitIndex)) return;  // Z, S, T on small n: unrolled kernel
+            uint64_t mask = uint64_t(1) << qubitIndex;
+            COMPLEX<T>* amp = reg.val.data();
+            COMPLEX<T> p(phase);
+            if(qubitIndex <= SimdLowQubitLimit<T>()){       // Runs shorter than a register: whole-register pairs
+                ForEachPairOp(amp, reg.val.size(), qubitIndex, SimdPhaseOp<T>{COMPLEX<T>(1), p, false});
+                return;
+            }
+            ForEachPairRun(reg.val.size(), qubitIndex, [=](uint64_t i, uint64_t len){
+                SimdPhaseRun(amp + (i | mask), len, p); // Only the |1⟩ half changes
+            });
+        }
+
+        std::optional<Matrix2> Matrix() const override {
+            return Matrix2{{1.0, 0.0, 0.0, phase}};
+        }
+
+        const char* Name() const override { return name; }
+
+        /**
+         * @brief Only the |1⟩ half is read and written
+         */
+        uint64_t AmplitudesTouched(uint64_t size) const { return size / 2; }
+
+    protected:
+        /**
+         * @brief Phases with a compile-time specialised kernel (StaticGates_cl.cpp)
+         */
+        enum class FixedPhase { None, Z, S, T };
+
+        PhaseGateR(COMPLEX<double> phaseFactor, const char* gateName, FixedPhase fixedPhase)
+            : phase(phaseFactor), name(gateName), fixed(fixedPhase) {}
+
+    private:
+        COMPLEX<double> phase;               ///< e^(iφ) applied to the |1⟩ amplitude
+        const char* name;                    ///< Gate label
+        FixedPhase fixed = FixedPhase::None; ///< Static kernel for small registers, if any
+
+        /**
+         * @brief Apply through the static kernel of a fixed phase; false for other phases or large n
+         */
+        template <typename T>
+        bool KernelStaticSmall(BasicRegister<T>& reg, int qubitIndex) const {
+            switch(fixed){
+                case FixedPhase::Z: return ApplyStaticSmall<StaticPauliZ>(reg.val.data(), reg.bits, qubitIndex);
+                case FixedPhase::S: return ApplyStaticSmall<StaticS>(reg.val.data(), reg.bits, qubitIndex);
+                case FixedPhase::T: return ApplyStaticSmall<StaticT>(reg.val.data(), reg.bits, qubitIndex);
+                default: return false;
             }
         }
 };
+/**
+ * @class ZGateR
+ * @brief Pauli-Z (phase flip) for registers: Z = diag(1, -1)
+ */
+class ZGateR : public PhaseGateR {
+    public:
+        ZGateR() : PhaseGateR(COMPLEX<double>(-1.0, 0.0), "Z", FixedPhase::Z) {}
+};
+/**
+ * @class SGateR
+ * @brief S (quarter turn) gate for registers: S = diag(1, i)
+ */
+class SGateR : public PhaseGateR {
+    public:
+        SGateR() : PhaseGateR(COMPLEX<double>(0.0, 1.0), "S", FixedPhase::S) {}
+};
+/**
+ * @class TGateR
+ * @brief T (π/8) gate for registers: T = diag(1, e^(iπ/4))
+ */
+class TGateR : public PhaseGateR {
+    public:
+        TGateR() : PhaseGateR(COMPLEX<double>(1.0/std::sqrt(2.0), 1.0/std::sqrt(2.0)), "T", FixedPhase::T) {}
+};
+
+/**
+ * @brief Apply an arbitrary 2×2 unitary to one qubit of the register
+ * @param amp, size State vector span (a whole register, or a 2^k slice of one);
+ *                  a BasicRegister overload forwards val.data(), val.size()
+ * @param qubitIndex Target qubit
+ * @param u Gate matrix
+ * 
+ * Diagonal matrices only scale amplitudes, so they skip the butterfly and
+ * touch the |0⟩ half only when u00 ≠ 1.
+ * 
+ * Time Complexity: O(2^n), Space Complexity: O(1)
+ */
+template <typename T>
+inline void ApplyMatrix2(COMPLEX<T>* amp, uint64_t size, int qubitIndex, const Matrix2& u){
+    uint64_t mask = uint64_t(1) << qubitIndex;
+    if(u.IsDiagonal()){
+        COMPLEX<T> p0(u.m[0]), p1(u.m[3]);
+        bool touchZero = std::abs(u.m[0] - 1.0) > 1e-15;
+        if(qubitIndex <= SimdLowQubitLimit<T>()){
+            ForEachPairOp(amp, size, qubitIndex, SimdPhaseOp<T>{p0, p1, touchZero});
+            return;
+        }
+        ForEachPairRun(size, qubitIndex, [=](uint64_t i, uint64_t len){
+            if(touchZero) SimdPhaseRun(amp + i, len, p0);
+            SimdPhaseRun(amp + (i | mask), len, p1);
+        });
+        return;
+    }
+    COMPLEX<T> um[4];
+    u.To(um);
+    ForEachPairOp(amp, size, qubitIndex, SimdMatrix2Op<T>{um});
+}
+template <typename T>
+inline void ApplyMatrix2(BasicRegister<T>& reg, int qubitIndex, const Matrix2& u){
+    ApplyMatrix2(reg.val.data(), reg.val.size(), qubitIndex, u);
+    reg.MarkDirty(true);
+}
+
+/**
+ * @brief Apply K independent single-qubit unitaries (U_{K-1} ⊗ ... ⊗ U_0) in one sweep
+ * @tparam K Number of qubits in the block (1..3)
+ * @param amp, size State vector span (a whole register, or a 2^k slice of one);
+ *                  a BasicRegister overload forwards val.data(), val.size()
+ * @param qubits Block qubits in ascending order
+ * @param u u[b] acts on qubits[b]
+ * 
+ * Base indices (all block bits cleared) are enumerated in contiguous runs, as
+ * in ForEachPairRun: consecutive bases differ only below the lowest block
+ * qubit, so each of the 2^K sub-states base | offset[l] is itself a
+ * contiguous run. All K butterflies are applied to those runs while they are
+ * cache resident, using the SIMD 2×2 kernel, so the state vector is read and
+ * written once for all K gates.
+ * 
+ * Time Complexity: O(2^n · K) arithmetic, one memory sweep; Space Complexity: O(2^K)
+ */
+template <int K, typename T>
+inline void ApplyTensorBlock(COMPLEX<T>* amp, uint64_t size, const int (&qubits)[K], const Matrix2 (&u)[K]){
+    constexpr int dim = 1 << K;
+    uint64_t offset[dim];                    // Index offset of each local basis state
+    for(int l = 0; l < dim; ++l){
+        offset[l] = 0;
+        for(int b = 0; b < K; ++b){
+            if((l >> b) & 1) offset[l] |= uint64_t(1) << qubits[b];
+        }
+    }
+
+    const uint64_t runMask = uint64_t(1) << qubits[0]; // Runs end at the lowest block bit
+    int q[K];
+    COMPLEX<T> um[K][4];
+    for(int b = 0; b < K; ++b){
+        q[b] = qubits[b];
+        u[b].To(um[b]);
+    }
+
+    ThreadPool::Instance().ParallelFor(size >> K, kPairsPerChunk, [&](uint64_t begin, uint64_t end){
+        for(uint64_t k = begin; k < end;){
+            uint64_t len = std::min(end - k, runMask - (k & (runMask - 1)));
+            uint64_t base = k;
+            for(int b = 0; b < K; ++b) base = InsertZeroBit(base, q[b]);
+
+            for(int b = 0; b < K; ++b){
+                for(int l = 0; l < dim; ++l){
+                    if((l >> b) & 1) continue;        // l = local index with bit b clear
+                    SimdMatrix2Run(amp + (base | offset[l]), amp + (base | offset[l | (1 << b)]), len, um[b]);
+                }
+            }
+            k += len;
+        }
+    });
+}
+template <int K, typename T>
+inline void ApplyTensorBlock(BasicRegister<T>& reg, const int (&qubits)[K], const Matrix2 (&u)[K]){
+    ApplyTensorBlock<K>(reg.val.data(), reg.val.size(), qubits, u);
+    reg.MarkDirty(true);
+}
+
+/**
+ * @brief Apply a 2×2 unitary to a target qubit, conditioned on control qubits
+ * @param amp, size State vector span (a whole register, or a 2^k slice of one);
+ *                  a BasicRegister overload forwards val.data(), val.size()
+ * @param targetIndex Target qubit
+ * @param controlMask Bitmask of control qubits (all must be |1⟩); 0 = uncontrolled
+ * @param u Gate matrix applied in the control-satisfied subspace
+ * 
+ * Only the control-satisfied subspace is enumerated (ForEachSubspaceRun), so
+ * a k-controlled gate touches 2^(n-k) amplitudes instead of scanning all 2^n.
+ * Diagonal gates (Z, S, T, CZ, CCZ, ...) take a phase-only path that also
+ * skips the target=0 half when u00 = 1, touching just 2^(n-k-1) amplitudes.
+ * 
+ * Example: CNOT(control 1 → target 0) is
+ * ApplyControlledMatrix2(reg, 0, 1 << 1, *XGateR().Matrix());
+ * 
+ * Time Complexity: O(2^(n-k)), Space Complexity: O(1)
+ */
+template <typename T>
+inline void ApplyControlledMatrix2(COMPLEX<T>* amp, uint64_t size, int targetIndex, uint64_t controlMask, const Matrix2& u){
+    const uint64_t tmask = uint64_t(1) << targetIndex;
+    assert(!(controlMask & tmask) && "Target qubit cannot also be a control");
+
+    if(u.IsDiagonal()){
+        COMPLEX<T> p0(u.m[0]), p1(u.m[3]);
+        if(std::abs(u.m[0] - 1.0) > 1e-15){
+            ForEachSubspaceRun(size, controlMask | tmask, controlMask, [=](uint64_t i, uint64_t len){
+                SimdPhaseRun(amp + i, len, p0);                 // target = 0 half
+            });
+        }
+        ForEachSubspaceRun(size, controlMask | tmask, controlMask | tmask, [=](uint64_t i, uint64_t len){
+            SimdPhaseRun(amp + i, len, p1);                     // target = 1 half
+        });
+        return;
+    }
+    COMPLEX<T> um[4];
+    u.To(um);
+    ForEachSubspaceRun(size, controlMask | tmask, controlMask, [=, &um](uint64_t i, uint64_t len){
+        SimdMatrix2Run(amp + i, amp + (i | tmask), len, um);
+    });
+}
+template <typename T>
+inline void ApplyControlledMatrix2(BasicRegister<T>& reg, int targetIndex, uint64_t controlMask, const Matrix2& u){
+    ApplyControlledMatrix2(reg.val.data(), reg.val.size(), targetIndex, controlMask, u);
+    reg.MarkDirty(true);
+}
+
+/**
+ * @brief Exchange two qubit positions: |..a..b..⟩ → |..b..a..⟩
+ * @param amp First amplitude of a span of 2^k entries
+ * @param size Span length
+ * @param qubitA First qubit
+ * @param qubitB Second qubit (≠ qubitA)
+ * 
+ * Only amplitudes whose two bits differ move: every index with bit a = 1 and
+ * bit b = 0 trades places with its partner (a = 0, b = 1), so the sweep
+ * touches half the state. Runs are contiguous below the lower of the two
+ * qubits, so swapping with a qubit just below the cache-block boundary keeps
+ * the runs long.
+ * 
+ * Time Complexity: O(2^(n-1)), Space Complexity: O(1)
+ */
+template <typename T>
+inline void ApplySwap(COMPLEX<T>* amp, uint64_t size, int qubitA, int qubitB){
+    assert(qubitA != qubitB && "Swap needs two distinct qubits");
+    const uint64_t maskA = uint64_t(1) << qubitA, maskB = uint64_t(1) << qubitB;
+    ForEachSubspaceRun(size, maskA | maskB, maskA, [=](uint64_t i, uint64_t len){
+        SimdSwapRun(amp + i, amp + (i ^ maskA ^ maskB), len);   // a=1,b=0 ↔ a=0,b=1
+    });
+}
+template <typename T>
+inline void ApplySwap(BasicRegister<T>& reg, int qubitA, int qubitB){
+    ApplySwap(reg.val.data(), reg.val.size(), qubitA, qubitB);
+    reg.MarkDirty(true);
+}
+
+/**
+ * @brief Reorder qubits: the bit at position q of every index moves to position perm[q]
+ * @param amp First amplitude of a span of 2^k entries
+ * @param size Span length
+ * @param perm Permutation of 0..k-1 (perm[q] = new position of qubit q)
+ * 
+ * The permutation is split into cycles and each cycle (c₀ c₁ ... c_m) into
+ * the transpositions (c₀ c₁), (c₀ c₂) ... (c₀ c_m), c₀ being its lowest qubit,
+ * so every step is an in-place ApplySwap (half the state moves, no scratch).
+ * Cycles are disjoint and commute; the ones that live entirely below
+ * kCacheLocalQubits go first. Every run of consecutive swaps that stays
+ * below kCacheLocalQubits is executed tile by tile: each 2^kCacheLocalQubits
+ * slice receives all swaps of the run while it is cache resident, so the
+ * run costs one sweep of the state instead of one per swap.
+ * 
+ * Time Complexity: O(s·2^(n-1)) for s swaps touching high qubits plus one
+ * sweep per run of low ones; Space Complexity: O(n)
+ */
+template <typename T>
+inline void ApplyQubitPermutation(COMPLEX<T>* amp, uint64_t size, const std::vector<int>& perm){
+    const int n = static_cast<int>(perm.size());
+    assert(size == (uint64_t(1) << n) && "Permutation must cover every qubit of the span");
+    std::vector<std::vector<int>> cycles;
+    std::vector<bool> seen(n, false);
+    for(int q = 0; q < n; ++q){
+        assert(perm[q] >= 0 && perm[q] < n && "Permutation entry out of range");
+        if(seen[q] || perm[q] == q) continue;
+        std::vector<int> cycle;
+        for(int c = q; !seen[c]; c = perm[c]){              // q is the lowest qubit of its cycle
+            seen[c] = true;
+            cycle.push_back(c);
+        }
+        assert(cycle.size() > 1 && perm[cycle.back()] == q && "perm is not a permutation");
+        cycles.push_back(std::move(cycle));
+    }
+    const int local = std::min(n, kCacheLocalQubits);
+    auto isLocal = [local](const std::vector<int>& cycle){
+        return *std::max_element(cycle.begin(), cycle.end()) < local;
+    };
+    std::stable_partition(cycles.begin(), cycles.end(), isLocal);
+
+    // Bit at c_j moves to c_{j+1}: (c₀ c_j) carries the bit parked on c₀ on to c_j
+    std::vector<std::pair<int, int>> swaps;
+    for(const auto& cycle : cycles){
+        for(size_t j = 1; j < cycle.size(); ++j)
+            swaps.push_back({cycle[0], cycle[j]});
+    }
+
+    const uint64_t tile = uint64_t(1) << local;
+    for(size_t s = 0; s < swaps.size();){
+        size_t e = s;
+        while(e < swaps.size() && swaps[e].first < local && swaps[e].second < local) ++e;
+        if(e - s >= 2){                                     // Tile the run of local swaps
+            ThreadPool::Instance().ParallelFor(size / tile, 1, [&](uint64_t first, uint64_t last){
+                for(uint64_t t = first; t < last; ++t){
+                    for(size_t k = s; k < e; ++k)
+                        ApplySwap(amp + t * tile, tile, swaps[k].first, swaps[k].second);  // Nested: runs inline
+                }
+            });
+            s = e;
+            continue;
+        }
+        ApplySwap(amp, size, swaps[s].first, swaps[s].second);
+        ++s;
+    }
+}
+template <typename T>
+inline void ApplyQubitPermutation(BasicRegister<T>& reg, const std::vector<int>& perm){
+    assert(static_cast<int>(perm.size()) == reg.bits && "Permutation must list every qubit");
+    ApplyQubitPermutation(reg.val.data(), reg.val.size(), perm);
+    reg.MarkDirty(true);
+}
+
+/**
+ * @brief Apply a classical reversible function as a basis permutation: |i⟩ → |table[i]⟩
+ * @param reg Register with 2^n amplitudes
+ * @param table Bijection on 0..2^n-1 (e.g. a reversible oracle's truth table)
+ * 
+ * When the memory budget leaves room for a second state vector, the
+ * amplitudes are scattered out of place in parallel (dst[table[i]] = src[i],
+ * every destination written exactly once) into a buffer from the register's
+ * pool, which then becomes the state. Otherwise the permutation runs in place
+ * by cycle following: the amplitudes of each cycle
+ * i → table[i] → table[table[i]] → ... rotate one step, and a packed bitmap
+ * (2^n bits, 1/128 of a double state) marks finished indices. That walk is
+ * serial; either way each amplitude is read and written once and the result
+ * does not depend on the thread count.
+ * 
+ * Time Complexity: O(2^n), Space Complexity: O(2^n) amplitudes out of place, O(2^n / 64) words in place
+ */
+template <typename T>
+inline void ApplyIndexPermutation(BasicRegister<T>& reg, const std::vector<uint64_t>& table){
+    const uint64_t size = reg.val.size();
+    assert(table.size() == size && "Permutation table needs one entry per basis state");
+    if(BasicRegister<T>::FitsMemoryBudget(reg.bits, 2 * sizeof(COMPLEX<T>))){
+        typename BasicRegister<T>::StateVector permuted(reg.val.get_allocator());
+        ResizeUninitialised(permuted, size);                // Every entry is written below
+        const COMPLEX<T>* src = reg.val.data();
+        COMPLEX<T>* dst = permuted.data();
+        const uint64_t* to = table.data();
+        ThreadPool::Instance().ParallelFor(size, kAmplitudesPerReduceChunk, [=](uint64_t begin, uint64_t end){
+            for(uint64_t i = begin; i < end; ++i){
+                assert(to[i] < size && "table is not a permutation");
+                dst[to[i]] = src[i];                        // |i⟩'s amplitude lands on |table[i]⟩
+            }
+        });
+        reg.val.swap(permuted);
+        reg.MarkDirty(true);
+        return;
+    }
+    COMPLEX<T>* amp = reg.val.data();
+    std::vector<uint64_t> done((size + 63) / 64, 0);
+    for(uint64_t start = 0; start < size; ++start){
+        if((done[start >> 6] >> (start & 63)) & 1) continue;
+        COMPLEX<T> carry = amp[start];
+        uint64_t j = table[start];
+        while(j != start){
+            assert(j < size && !((done[j >> 6] >> (j & 63)) & 1) && "table is not a permutation");
+            std::swap(carry, amp[j]);                       // |i⟩'s amplitude lands on |table[i]⟩
+            done[j >> 6] |= uint64_t(1) << (j & 63);
+            j = table[j];
+        }
+        amp[start] = carry;
+        done[start >> 6] |= uint64_t(1) << (start & 63);
+    }
+    reg.MarkDirty(true);
+}
+/**
+ * @class MatrixGateR
+ * @brief Register gate applying an arbitrary 2×2 unitary
+ * 
+ * Example: a rotation Rz(θ)
+ * MatrixGateR rz({{std::polar(1.0, -θ/2), 0.0, 0.0, std::polar(1.0, θ/2)}});
+ * rz.ApplyToSingle(reg, 2);
+ */
+class MatrixGateR : public RGateKernels<MatrixGateR> {
+    public:
+        explicit MatrixGateR(const Matrix2& matrix) : u(matrix) {}
+
+        template <typename T>
+        void Kernel(BasicRegister<T>& reg, int qubitIndex) const {
+            ApplyMatrix2(reg, qubitIndex, u);
+        }
+
+        std::optional<Matrix2> Matrix() const override {
+            return u;
+        }
+
+        const char* Name() const override { return "Matrix"; }
+
+    private:
+        Matrix2 u;                           ///< Gate matrix
+};
+/**
+ * @class ControlledGateR
+ * @brief Register gate applying a 2×2 unitary under a set of control qubits
+ * 
+ * Matrix Representation (one control, target below):
+ * C-U = |I 0|
+ *       |0 U|
+ * 
+ * Transformations:
+ * |c⟩|t⟩ → |c⟩|t⟩      if any control c = 0
+ * |c⟩|t⟩ → |c⟩ U|t⟩    if all controls are 1
+ * 
+ * The controls are fixed at construction; ApplyToSingle() chooses the target.
+ */
+class ControlledGateR : public RGateKernels<ControlledGateR> {
+    public:
+        /**
+         * @brief Construct a controlled gate
+         * @param matrix Unitary applied to the target when all controls are |1⟩
+         * @param controls Control qubit indices
+         * @param gateName Name reported by Name() (CNOT, CZ and Toffoli pass their own)
+         */
+        ControlledGateR(const Matrix2& matrix, const std::vector<int>& controls, const char* gateName = "Controlled")
+            : u(matrix), controlMask(0), name(gateName) {
+            for(int c : controls){
+                controlMask |= uint64_t(1) << c;
+            }
+        }
+
+        /**
+         * @brief Apply the controlled gate with the given target qubit
+         * @param reg Reference to the quantum register
+         * @param qubitIndex Target qubit (must not be a control)
+         * 
+         * Time Complexity: O(2^(n-k)) for k controls
+         */
+        template <typename T>
+        void Kernel(BasicRegister<T>& reg, int qubitIndex) const {
+            ApplyControlledMatrix2(reg, qubitIndex, controlMask, u);
+        }
+
+        /**
+         * @brief Apply the controlled gate once to every non-control qubit
+         */
+        template <typename T>
+        void KernelAll(BasicRegister<T>& reg) const {
+            for(int i = 0; i < reg.bits; ++i){
+                if(!((controlMask >> i) & 1)) Kernel(reg, i);
+            }
+        }
+
+        /**
+         * @brief Unitary applied to the target in the control-satisfied subspace
+         */
+        const Matrix2& TargetMatrix() const {
+            return u;
+        }
+
+        /**
+         * @brief Bitmask of the control qubits
+         */
+        uint64_t ControlMask() const {
+            return controlMask;
+        }
+
+        const char* Name() const override { return name; }
+
+        /**
+         * @brief Only the control-satisfied 2^(n-k) amplitudes are read and written
+         */
+        uint64_t AmplitudesTouched(uint64_t size) const { return size >> std::bitset<64>(controlMask).count(); }
+
+    private:
+        Matrix2 u;                           ///< Gate matrix on the target
+        uint64_t controlMask;                ///< Bitmask of control qubits
+        const char* name;                    ///< Gate label
+};
+/**
+ * @class CNotGateR
+ * @brief Controlled-NOT: flips the target when the control is |1⟩
+ * 
+ * Example (Bell state): H on qubit 1, then CNotGateR(1).ApplyToSingle(reg, 0)
+ * gives (|00⟩ + |11⟩)/√2.
+ */
+class CNotGateR : public ControlledGateR {
+    public:
+        explicit CNotGateR(int control) : ControlledGateR(Matrix2{{0.0, 1.0, 1.0, 0.0}}, {control}, "CNOT") {}
+};
+/**
+ * @class CZGateR
+ * @brief Controlled-Z: phase -1 on |11⟩ (symmetric, phase-only fast path)
+ */
+class CZGateR : public ControlledGateR {
+    public:
+        explicit CZGateR(int control) : ControlledGateR(Matrix2{{1.0, 0.0, 0.0, -1.0}}, {control}, "CZ") {}
+};
+/**
+ * @class ToffoliGateR
+ * @brief Controlled-controlled-NOT: flips the target when both controls are |1⟩
+ */
+class ToffoliGateR : public ControlledGateR {
+    public:
+        ToffoliGateR(int control1, int control2) : ControlledGateR(Matrix2{{0.0, 1.0, 1.0, 0.0}}, {control1, control2}, "Toffoli") {}
+};
 
 /**
  * @brief Main function demonstrating quantum gate operations
@@ -272,3 +1112,5 @@ class XGateR : public RGates {
 
 //     return 0;
 // }
+
+#endif // REGISTER_GATES_CL_CPP
@@ -0,0 +1,285 @@
+/**
+ * @file RegisterSoA_cl.cpp
+ * @brief Structure-of-arrays state vector backend with 64-byte aligned storage
+ *
+ * Register stores amplitudes interleaved: [re₀, im₀, re₁, im₁, ...]. That suits
+ * std::complex arithmetic but means every vector register mixes real and
+ * imaginary lanes, requiring shuffles for complex multiplies.
+ *
+ * RegisterSoA stores the same state as two separate arrays:
+ *   re = [re₀, re₁, re₂, ...]      im = [im₀, im₁, im₂, ...]
+ * Each 64-byte aligned, so a cache line holds 8 consecutive real (or
+ * imaginary) parts and every gate update becomes plain element-wise arithmetic
+ * that the compiler vectorises with aligned loads and no lane shuffles.
+ *
+ * Usage:
+ * Register reg(20);
+ * RegisterSoA soa(reg);          // Convert once
+ * soa.ApplyHadamard(0);          // Run many gates in SoA layout
+ * soa.ApplyT(3);
+ * Register back = soa.ToRegister();
+ *
+ * @author Your Name
+ * @date 2025
+ */
+
+#ifndef REGISTER_SOA_CL_CPP
+#define REGISTER_SOA_CL_CPP
+
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "RegisterGates_cl.cpp"
+
+/**
+ * @class AlignedAllocator
+ * @brief Minimal std::allocator replacement returning Alignment-byte aligned blocks
+ * @tparam T Element type
+ * @tparam Alignment Required alignment in bytes (power of two)
+ */
+template <typename T, size_t Alignment = 64>
+struct AlignedAllocator
+{
+    using value_type = T;
+
+    template <typename U>
+    struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment> &) {}
+
+    T *allocate(size_t n)
+    {
+        return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+    void deallocate(T *p, size_t)
+    {
+        ::operator delete(p, std::align_val_t(Alignment));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment> &) const { return true; }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment> &) const { return false; }
+};
+
+/**
+ * @class RegisterSoA
+ * @brief Quantum register with split real/imaginary amplitude arrays
+ *
+ * Offers the H/X/Y/Z/S/T gates plus MagnitudeSquareSum and FindInnerProduct
+ * directly on the SoA layout. Gate kernels share the pair enumeration of the
+ * interleaved register gates (ForEachPairRun) and the reductions run through
+ * ThreadPool::ParallelReduce, so both are parallel and cache-chunked in the
+ * same way; reductions are thread-count independent.
+ */
+class RegisterSoA
+{
+public:
+    using Array = std::vector<double, AlignedAllocator<double, 64>>;
+
+    int bits;   ///< Number of qubits
+    Array re;   ///< Real parts, re[i] = Re(αᵢ)
+    Array im;   ///< Imaginary parts, im[i] = Im(αᵢ)
+
+    /**
+     * @brief Create an n-qubit register in |00...0⟩
+     * @throws std::length_error if the two arrays exceed Register's memory budget
+     */
+    explicit RegisterSoA(int n) : bits(n), re(CheckedSize(n), 0.0), im(CheckedSize(n), 0.0)
+    {
+        re[0] = 1.0;
+    }
+
+    /**
+     * @brief Convert an interleaved Register into SoA layout
+     * @complexity Time: O(2^n), Space: O(2^n)
+     */
+    explicit RegisterSoA(const Register &reg) : bits(reg.bits), re(reg.val.size()), im(reg.val.size())
+    {
+        for (size_t i = 0; i < reg.val.size(); ++i)
+        {
+            re[i] = reg.val[i].real();
+            im[i] = reg.val[i].imag();
+        }
+    }
+
+    /**
+     * @brief Convert back to an interleaved Register
+     * @complexity Time: O(2^n), Space: O(2^n)
+     */
+    Register ToRegister() const
+    {
+        Register reg(bits);
+        for (size_t i = 0; i < re.size(); ++i)
+        {
+            reg.val[i] = COMPLEX<double>(re[i], im[i]);
+        }
+        reg.MarkDirty();
+        return reg;
+    }
+
+    /**
+     * @brief Hadamard on one qubit: (a, b) → ((a+b)/√2, (a-b)/√2)
+     */
+    void ApplyHadamard(int qubitIndex)
+    {
+        const double s = 1.0 / std::sqrt(2.0);
+        ForEachRun(qubitIndex, [s](double *__restrict ar, double *__restrict ai,
+                                   double *__restrict br, double *__restrict bi, uint64_t len) {
+            for (uint64_t k = 0; k < len; ++k)
+            {
+                double xr = ar[k], xi = ai[k], yr = br[k], yi = bi[k];
+                ar[k] = (xr + yr) * s;
+                ai[k] = (xi + yi) * s;
+                br[k] = (xr - yr) * s;
+                bi[k] = (xi - yi) * s;
+            }
+        });
+    }
+
+    /**
+     * @brief Pauli-X on one qubit: swap the two halves
+     */
+    void ApplyX(int qubitIndex)
+    {
+        ForEachRun(qubitIndex, [](double *__restrict ar, double *__restrict ai,
+                                  double *__restrict br, double *__restrict bi, uint64_t len) {
+            for (uint64_t k = 0; k < len; ++k)
+            {
+                std::swap(ar[k], br[k]);
+                std::swap(ai[k], bi[k]);
+            }
+        });
+    }
+
+    /**
+     * @brief Pauli-Y on one qubit: (a, b) → (-i·b, i·a)
+     */
+    void ApplyY(int qubitIndex)
+    {
+        ForEachRun(qubitIndex, [](double *__restrict ar, double *__restrict ai,
+                                  double *__restrict br, double *__restrict bi, uint64_t len) {
+            for (uint64_t k = 0; k < len; ++k)
+            {
+                double xr = ar[k], xi = ai[k], yr = br[k], yi = bi[k];
+                ar[k] = yi;                 // -i(yr + i·yi) = yi - i·yr
+                ai[k] = -yr;
+                br[k] = -xi;                // i(xr + i·xi) = -xi + i·xr
+                bi[k] = xr;
+            }
+        });
+    }
+
+    void ApplyZ(int qubitIndex) { ApplyPhase(qubitIndex, COMPLEX<double>(-1.0, 0.0)); }
+    void ApplyS(int qubitIndex) { ApplyPhase(qubitIndex, COMPLEX<double>(0.0, 1.0)); }
+    void ApplyT(int qubitIndex) { ApplyPhase(qubitIndex, COMPLEX<double>(1.0 / std::sqrt(2.0), 1.0 / std::sqrt(2.0))); }
+
+    /**
+     * @brief Diagonal gate diag(1, phase): only the target=1 half is touched
+     */
+    void ApplyPhase(int qubitIndex, COMPLEX<double> phase)
+    {
+        const double pr = phase.real(), pi = phase.imag();
+        ForEachRun(qubitIndex, [pr, pi](double *, double *,
+                                        double *__restrict br, double *__restrict bi, uint64_t len) {
+            for (uint64_t k = 0; k < len; ++k)
+            {
+                double yr = br[k], yi = bi[k];
+                br[k] = yr * pr - yi * pi;
+                bi[k] = yr * pi + yi * pr;
+            }
+        });
+    }
+
+    /**
+     * @brief Σ |αᵢ|² over the split arrays
+     *
+     * Parallel over kAmplitudesPerReduceChunk chunks; each chunk keeps four
+     * independent partial sums so the adds pipeline without -ffast-math.
+     * 
+     * @complexity Time: O(2^n), Space: O(1)
+     */
+    double MagnitudeSquareSum() const
+    {
+        const double *r = re.data();
+        const double *i = im.data();
+        return ThreadPool::Instance().ParallelReduce(re.size(), kAmplitudesPerReduceChunk, 0.0,
+            [r, i](uint64_t begin, uint64_t end) {
+                double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+                uint64_t k = begin;
+                for (; k + 2 <= end; k += 2)
+                {
+                    s0 += r[k] * r[k];
+                    s1 += i[k] * i[k];
+                    s2 += r[k + 1] * r[k + 1];
+                    s3 += i[k + 1] * i[k + 1];
+                }
+                for (; k < end; ++k)
+                    s0 += r[k] * r[k] + i[k] * i[k];
+                return (s0 + s1) + (s2 + s3);
+            });
+    }
+
+    /**
+     * @brief ⟨ψ|φ⟩ = Σ conj(ψᵢ)·φᵢ with both states in SoA layout
+     * @complexity Time: O(2^n), Space: O(1)
+     */
+    COMPLEX<double> FindInnerProduct(const RegisterSoA &other) const
+    {
+        assert(re.size() == other.re.size());
+        const double *ar = re.data();
+        const double *ai = im.data();
+        const double *br = other.re.data();
+        const double *bi = other.im.data();
+        return ThreadPool::Instance().ParallelReduce(re.size(), kAmplitudesPerReduceChunk, COMPLEX<double>(0.0, 0.0),
+            [ar, ai, br, bi](uint64_t begin, uint64_t end) {
+                double re0 = 0.0, re1 = 0.0, im0 = 0.0, im1 = 0.0;     // Two chains per component
+                uint64_t k = begin;
+                for (; k + 2 <= end; k += 2)
+                {
+                    re0 += ar[k] * br[k] + ai[k] * bi[k];
+                    im0 += ar[k] * bi[k] - ai[k] * br[k];
+                    re1 += ar[k + 1] * br[k + 1] + ai[k + 1] * bi[k + 1];
+                    im1 += ar[k + 1] * bi[k + 1] - ai[k + 1] * br[k + 1];
+                }
+                for (; k < end; ++k)
+                {
+                    re0 += ar[k] * br[k] + ai[k] * bi[k];
+                    im0 += ar[k] * bi[k] - ai[k] * br[k];
+                }
+                return COMPLEX<double>(re0 + re1, im0 + im1);
+            });
+    }
+
+private:
+    /**
+     * @brief 2^n after checking both arrays (16 bytes per amplitude) against the budget
+     */
+    static uint64_t CheckedSize(int n)
+    {
+        Register::CheckMemoryBudget(n, 2 * sizeof(double));
+        return uint64_t(1) << n;
+    }
+
+    /**
+     * @brief Hand each contiguous pair run to kernel(ar, ai, br, bi, len)
+     *
+     * The "a" pointers address the target=0 run, the "b" pointers the
+     * matching target=1 run 2^q elements later.
+     */
+    template <typename F>
+    void ForEachRun(int qubitIndex, F kernel)
+    {
+        const uint64_t mask = uint64_t(1) << qubitIndex;
+        double *r = re.data();
+        double *i = im.data();
+        ForEachPairRun(re.size(), qubitIndex, [=](uint64_t start, uint64_t len) {
+            kernel(r + start, i + start, r + (start | mask), i + (start | mask), len);
+        });
+    }
+};
+
+#endif // REGISTER_SOA_CL_CPP
@@ -0,0 +1,747 @@
+/**
+ * @file Simd_cl.cpp
+ * @brief SIMD kernels for amplitude-pair updates and state-vector reductions
+ *
+ * Every single-qubit register gate reduces to the same shape of work: for each
+ * pair of amplitudes (a, b) = (val[i], val[i | mask]) apply a 2×2 update. For
+ * target qubit q ≥ 1 the "a" indices come in contiguous runs of 2^q, with the
+ * matching "b" run exactly mask elements later, so a run can be processed
+ * several complex numbers at a time.
+ *
+ * Backends (selected at compile time from the target ISA flags):
+ * - AVX-512F  (-mavx512f):  4 complex<double> / 8 complex<float> per register
+ * - AVX2/AVX  (-mavx2 -mfma): 2 complex<double> / 4 complex<float> per register
+ * - Scalar fallback:        1 complex per "register"
+ *
+ * Each backend exposes the same tiny vocabulary (Load, Store, Add, Sub, Mul,
+ * SwapReIm, CMul, ...) over interleaved (re, im) scalars, and the kernels below
+ * are written once against that vocabulary, templated on the amplitude scalar
+ * type T (double → Simd, float → SimdF, see SimdOf<T>). Elements left over
+ * after the vector loop are handled by the scalar backend.
+ *
+ * Low target qubits:
+ * For a target q with 2^q < kComplexPerReg a run is shorter than one
+ * register, so the run kernels would fall back to the scalar tail. Instead
+ * SimdLowPairRun() loads two whole registers of consecutive amplitudes,
+ * separates the partners with one lane permute each (SplitPairs<q>), applies
+ * the gate's pair operation to full registers and interleaves the result
+ * back (MergePairs<q>). The pair operations (SimdHadamardOp, SimdSwapOp,
+ * SimdPauliYOp, SimdPhaseOp, SimdMatrix2Op) are shared with the run kernels.
+ *
+ * Reductions always accumulate into double: vector partial sums are flushed
+ * every kReduceBlock amplitudes, so single-precision states keep a
+ * double-precision norm and inner product.
+ *
+ * Build Example:
+ * g++ -std=c++17 -O2 -march=native -pthread DeutscheAlgo_example.cpp
+ *
+ * @author Your Name
+ * @date 2025
+ */
+
+#ifndef SIMD_CL_CPP
+#define SIMD_CL_CPP
+
+#include <algorithm>
+#include <array>
+#include <complex>
+#include <cstddef>
+#include <utility>
+
+#if defined(__AVX512F__) || defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+/// Amplitudes accumulated in vector registers before a reduction flushes to double
+constexpr size_t kReduceBlock = 4096;
+
+/**
+ * @struct SimdScalarT
+ * @brief Portable one-complex-at-a-time backend (also used for loop tails)
+ * @tparam T Amplitude scalar type (float or double)
+ */
+template <typename T>
+struct SimdScalarT
+{
+    struct reg { T re, im; };
+    static constexpr size_t kComplexPerReg = 1;
+    static constexpr const char *kName = "scalar";
+
+    static reg Load(const std::complex<T> *p) { return {p->real(), p->imag()}; }
+    static void Store(std::complex<T> *p, reg v) { *p = {v.re, v.im}; }
+    static reg Set1(T x) { return {x, x}; }
+    static reg Zero() { return {0.0, 0.0}; }
+    static reg Add(reg a, reg b) { return {a.re + b.re, a.im + b.im}; }
+    static reg Sub(reg a, reg b) { return {a.re - b.re, a.im - b.im}; }
+    static reg Mul(reg a, reg b) { return {a.re * b.re, a.im * b.im}; }
+    static reg SwapReIm(reg a) { return {a.im, a.re}; }
+    static reg NegRe(reg a) { return {-a.re, a.im}; }
+    static reg NegIm(reg a) { return {a.re, -a.im}; }
+    /// Complex multiply every lane by phase (pr + i·pi)
+    static reg CMul(reg a, T pr, T pi) { return {a.re * pr - a.im * pi, a.re * pi + a.im * pr}; }
+    static double Sum(reg a) { return double(a.re) + double(a.im); }
+};
+using SimdScalar = SimdScalarT<double>;
+using SimdScalarF = SimdScalarT<float>;
+
+#if defined(__AVX512F__)
+/**
+ * @brief _mm512_permutex2var_pd indices separating or rejoining the partners of a low qubit
+ * @param q Target qubit (2^q < complex per register)
+ * @param per 64-bit elements per complex (2 for double, 1 for float)
+ * @param merge false: pick the partners out of x‖y; true: interleave a‖b back
+ * @param second false: first output (a, or x); true: second output (b, or y)
+ *
+ * Index bit 3 selects the second source register. Split slot k of a holds
+ * the k-th complex of x‖y with bit q clear, the same slot of b its partner.
+ */
+constexpr std::array<long long, 8> LowPairIndex(int q, int per, bool merge, bool second)
+{
+    std::array<long long, 8> idx{};
+    const int lanes = 8 / per;                          // Complex per register
+    const int low = (1 << q) - 1;
+    for (int e = 0; e < 8; ++e)
+    {
+        const int k = e / per, r = e % per;
+        if (!merge)
+        {
+            const int c = ((k >> q) << (q + 1)) | (k & low) | (second ? 1 << q : 0);
+            idx[e] = c * per + r;
+        }
+        else
+        {
+            const int c = k + (second ? lanes : 0);
+            const int slot = ((c >> (q + 1)) << q) | (c & low);
+            idx[e] = (((c >> q) & 1) ? 8 : 0) + slot * per + r;
+        }
+    }
+    return idx;
+}
+
+/**
+ * @struct SimdAvx512
+ * @brief AVX-512F backend: one __m512d holds 4 interleaved complex<double>
+ */
+struct SimdAvx512
+{
+    using reg = __m512d;
+    static constexpr size_t kComplexPerReg = 4;
+    static constexpr const char *kName = "avx512";
+
+    static reg Load(const std::complex<double> *p) { return _mm512_loadu_pd(reinterpret_cast<const double *>(p)); }
+    static void Store(std::complex<double> *p, reg v) { _mm512_storeu_pd(reinterpret_cast<double *>(p), v); }
+    static reg Set1(double x) { return _mm512_set1_pd(x); }
+    static reg Zero() { return _mm512_setzero_pd(); }
+    static reg Add(reg a, reg b) { return _mm512_add_pd(a, b); }
+    static reg Sub(reg a, reg b) { return _mm512_sub_pd(a, b); }
+    static reg Mul(reg a, reg b) { return _mm512_mul_pd(a, b); }
+    static reg SwapReIm(reg a) { return _mm512_shuffle_pd(a, a, 0x55); }
+    static reg NegRe(reg a) { return Xor(a, _mm512_set_pd(0.0, -0.0, 0.0, -0.0, 0.0, -0.0, 0.0, -0.0)); }
+    static reg NegIm(reg a) { return Xor(a, _mm512_set_pd(-0.0, 0.0, -0.0, 0.0, -0.0, 0.0, -0.0, 0.0)); }
+    static reg CMul(reg a, double pr, double pi)
+    {
+        // even lanes: re·pr - im·pi, odd lanes: im·pr + re·pi
+        return _mm512_fmaddsub_pd(a, Set1(pr), Mul(SwapReIm(a), Set1(pi)));
+    }
+    static double Sum(reg a)
+    {
+        // Called once per reduction, so a spill beats a shuffle tree
+        alignas(64) double lanes[8];
+        _mm512_store_pd(lanes, a);
+        return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    }
+    /**
+     * @brief x‖y hold 8 consecutive amplitudes; a gets those with bit Q clear, b their partners
+     */
+    template <int Q>
+    static void SplitPairs(reg x, reg y, reg &a, reg &b)
+    {
+        static constexpr std::array<long long, 8> ia = LowPairIndex(Q, 2, false, false), ib = LowPairIndex(Q, 2, false, true);
+        a = _mm512_permutex2var_pd(x, _mm512_loadu_si512(ia.data()), y);
+        b = _mm512_permutex2var_pd(x, _mm512_loadu_si512(ib.data()), y);
+    }
+    /**
+     * @brief Inverse of SplitPairs<Q>
+     */
+    template <int Q>
+    static void MergePairs(reg a, reg b, reg &x, reg &y)
+    {
+        static constexpr std::array<long long, 8> ix = LowPairIndex(Q, 2, true, false), iy = LowPairIndex(Q, 2, true, true);
+        x = _mm512_permutex2var_pd(a, _mm512_loadu_si512(ix.data()), b);
+        y = _mm512_permutex2var_pd(a, _mm512_loadu_si512(iy.data()), b);
+    }
+
+private:
+    static reg Xor(reg a, reg m)
+    {
+        return _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(a), _mm512_castpd_si512(m)));
+    }
+};
+using Simd = SimdAvx512;
+
+/**
+ * @struct SimdAvx512F
+ * @brief AVX-512F backend: one __m512 holds 8 interleaved complex<float>
+ */
+struct SimdAvx512F
+{
+    using reg = __m512;
+    static constexpr size_t kComplexPerReg = 8;
+    static constexpr const char *kName = "avx512";
+
+    static reg Load(const std::complex<float> *p) { return _mm512_loadu_ps(reinterpret_cast<const float *>(p)); }
+    static void Store(std::complex<float> *p, reg v) { _mm512_storeu_ps(reinterpret_cast<float *>(p), v); }
+    static reg Set1(float x) { return _mm512_set1_ps(x); }
+    static reg Zero() { return _mm512_setzero_ps(); }
+    static reg Add(reg a, reg b) { return _mm512_add_ps(a, b); }
+    static reg Sub(reg a, reg b) { return _mm512_sub_ps(a, b); }
+    static reg Mul(reg a, reg b) { return _mm512_mul_ps(a, b); }
+    static reg SwapReIm(reg a) { return _mm512_shuffle_ps(a, a, 0xB1); }
+    // One 64-bit pattern per complex: sign bit of the low (re) or high (im) float
+    static reg NegRe(reg a) { return Xor(a, _mm512_set1_epi64(0x0000000080000000LL)); }
+    static reg NegIm(reg a) { return Xor(a, _mm512_set1_epi64(static_cast<long long>(0x8000000000000000ULL))); }
+    static reg CMul(reg a, float pr, float pi)
+    {
+        return _mm512_fmaddsub_ps(a, Set1(pr), Mul(SwapReIm(a), Set1(pi)));
+    }
+    static double Sum(reg a)
+    {
+        alignas(64) float lanes[16];
+        _mm512_store_ps(lanes, a);
+        double total = 0.0;
+        for (float x : lanes)
+            total += x;
+        return total;
+    }
+    /**
+     * @brief x‖y hold 16 consecutive amplitudes; a gets those with bit Q clear, b their partners
+     *
+     * A complex<float> is one 64-bit lane, so the double permute moves whole amplitudes.
+     */
+    template <int Q>
+    static void SplitPairs(reg x, reg y, reg &a, reg &b)
+    {
+        static constexpr std::array<long long, 8> ia = LowPairIndex(Q, 1, false, false), ib = LowPairIndex(Q, 1, false, true);
+        a = Permute(x, ia, y);
+        b = Permute(x, ib, y);
+    }
+    /**
+     * @brief Inverse of SplitPairs<Q>
+     */
+    template <int Q>
+    static void MergePairs(reg a, reg b, reg &x, reg &y)
+    {
+        static constexpr std::array<long long, 8> ix = LowPairIndex(Q, 1, true, false), iy = LowPairIndex(Q, 1, true, true);
+        x = Permute(a, ix, b);
+        y = Permute(a, iy, b);
+    }
+
+private:
+    static reg Xor(reg a, __m512i m)
+    {
+        return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a), m));
+    }
+    static reg Permute(reg a, const std::array<long long, 8> &idx, reg b)
+    {
+        return _mm512_castpd_ps(_mm512_permutex2var_pd(_mm512_castps_pd(a), _mm512_loadu_si512(idx.data()), _mm512_castps_pd(b)));
+    }
+};
+using SimdF = SimdAvx512F;
+#elif defined(__AVX__)
+/**
+ * @struct SimdAvx2
+ * @brief AVX/AVX2 backend: one __m256d holds 2 interleaved complex<double>
+ */
+struct SimdAvx2
+{
+    using reg = __m256d;
+    static constexpr size_t kComplexPerReg = 2;
+    static constexpr const char *kName = "avx2";
+
+    static reg Load(const std::complex<double> *p) { return _mm256_loadu_pd(reinterpret_cast<const double *>(p)); }
+    static void Store(std::complex<double> *p, reg v) { _mm256_storeu_pd(reinterpret_cast<double *>(p), v); }
+    static reg Set1(double x) { return _mm256_set1_pd(x); }
+    static reg Zero() { return _mm256_setzero_pd(); }
+    static reg Add(reg a, reg b) { return _mm256_add_pd(a, b); }
+    static reg Sub(reg a, reg b) { return _mm256_sub_pd(a, b); }
+    static reg Mul(reg a, reg b) { return _mm256_mul_pd(a, b); }
+    static reg SwapReIm(reg a) { return _mm256_permute_pd(a, 0x5); }
+    static reg NegRe(reg a) { return _mm256_xor_pd(a, _mm256_set_pd(0.0, -0.0, 0.0, -0.0)); }
+    static reg NegIm(reg a) { return _mm256_xor_pd(a, _mm256_set_pd(-0.0, 0.0, -0.0, 0.0)); }
+    static reg CMul(reg a, double pr, double pi)
+    {
+        // even lanes: re·pr - im·pi, odd lanes: im·pr + re·pi
+#if defined(__FMA__)
+        return _mm256_fmaddsub_pd(a, Set1(pr), Mul(SwapReIm(a), Set1(pi)));
+#else
+        return _mm256_addsub_pd(Mul(a, Set1(pr)), Mul(SwapReIm(a), Set1(pi)));
+#endif
+    }
+    static double Sum(reg a)
+    {
+        __m128d lo = _mm256_castpd256_pd128(a);
+        __m128d hi = _mm256_extractf128_pd(a, 1);
+        lo = _mm_add_pd(lo, hi);
+        return _mm_cvtsd_f64(_mm_add_sd(lo, _mm_unpackhi_pd(lo, lo)));
+    }
+    /**
+     * @brief x‖y hold 4 consecutive amplitudes; a gets those with bit 0 clear, b their partners
+     */
+    template <int Q>
+    static void SplitPairs(reg x, reg y, reg &a, reg &b)
+    {
+        static_assert(Q == 0, "Two complex<double> per register: only qubit 0 is below a register");
+        a = _mm256_permute2f128_pd(x, y, 0x20);
+        b = _mm256_permute2f128_pd(x, y, 0x31);
+    }
+    /**
+     * @brief Inverse of SplitPairs<Q> (the same 128-bit lane exchange)
+     */
+    template <int Q>
+    static void MergePairs(reg a, reg b, reg &x, reg &y)
+    {
+        SplitPairs<Q>(a, b, x, y);
+    }
+};
+using Simd = SimdAvx2;
+
+/**
+ * @struct SimdAvx2F
+ * @brief AVX/AVX2 backend: one __m256 holds 4 interleaved complex<float>
+ */
+struct SimdAvx2F
+{
+    using reg = __m256;
+    static constexpr size_t kComplexPerReg = 4;
+    static constexpr const char *kName = "avx2";
+
+    static reg Load(const std::complex<float> *p) { return _mm256_loadu_ps(reinterpret_cast<const float *>(p)); }
+    static void Store(std::complex<float> *p, reg v) { _mm256_storeu_ps(reinterpret_cast<float *>(p), v); }
+    static reg Set1(float x) { return _mm256_set1_ps(x); }
+    static reg Zero() { return _mm256_setzero_ps(); }
+    static reg Add(reg a, reg b) { return _mm256_add_ps(a, b); }
+    static reg Sub(reg a, reg b) { return _mm256_sub_ps(a, b); }
+    static reg Mul(reg a, reg b) { return _mm256_mul_ps(a, b); }
+    static reg SwapReIm(reg a) { return _mm256_permute_ps(a, 0xB1); }
+    // One 64-bit pattern per complex: sign bit of the low (re) or high (im) float
+    static reg NegRe(reg a) { return _mm256_xor_ps(a, _mm256_castsi256_ps(_mm256_set1_epi64x(0x0000000080000000LL))); }
+    static reg NegIm(reg a) { return _mm256_xor_ps(a, _mm256_castsi256_ps(_mm256_set1_epi64x(static_cast<long long>(0x8000000000000000ULL)))); }
+    static reg CMul(reg a, float pr, float pi)
+    {
+#if defined(__FMA__)
+        return _mm256_fmaddsub_ps(a, Set1(pr), Mul(SwapReIm(a), Set1(pi)));
+#else
+        return _mm256_addsub_ps(Mul(a, Set1(pr)), Mul(SwapReIm(a), Set1(pi)));
+#endif
+    }
+    static double Sum(reg a)
+    {
+        __m128 lo = _mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+        __m128d wide = _mm_add_pd(_mm_cvtps_pd(lo), _mm_cvtps_pd(_mm_movehl_ps(lo, lo)));
+        return _mm_cvtsd_f64(_mm_add_sd(wide, _mm_unpackhi_pd(wide, wide)));
+    }
+    /**
+     * @brief x‖y hold 8 consecutive amplitudes; a gets those with bit Q clear, b their partners
+     *
+     * A complex<float> is one 64-bit lane: qubit 0 pairs neighbouring lanes
+     * (unpack), qubit 1 neighbouring 128-bit halves. Both are self-inverse.
+     */
+    template <int Q>
+    static void SplitPairs(reg x, reg y, reg &a, reg &b)
+    {
+        static_assert(Q == 0 || Q == 1, "Four complex<float> per register: qubits 0 and 1 are below a register");
+        const __m256d xd = _mm256_castps_pd(x), yd = _mm256_castps_pd(y);
+        if constexpr (Q == 0)
+        {
+            a = _mm256_castpd_ps(_mm256_unpacklo_pd(xd, yd));
+            b = _mm256_castpd_ps(_mm256_unpackhi_pd(xd, yd));
+        }
+        else
+        {
+            a = _mm256_castpd_ps(_mm256_permute2f128_pd(xd, yd, 0x20));
+            b = _mm256_castpd_ps(_mm256_permute2f128_pd(xd, yd, 0x31));
+        }
+    }
+    /**
+     * @brief Inverse of SplitPairs<Q>
+     */
+    template <int Q>
+    static void MergePairs(reg a, reg b, reg &x, reg &y)
+    {
+        SplitPairs<Q>(a, b, x, y);
+    }
+};
+using SimdF = SimdAvx2F;
+#else
+using Simd = SimdScalar;
+using SimdF = SimdScalarF;
+#endif
+
+/**
+ * @brief Backend for amplitude scalar type T: SimdOf<double> = Simd, SimdOf<float> = SimdF
+ */
+template <typename T> struct SimdBackend;
+template <> struct SimdBackend<double> { using type = Simd; };
+template <> struct SimdBackend<float> { using type = SimdF; };
+template <typename T>
+using SimdOf = typename SimdBackend<T>::type;
+
+/**
+ * @struct SimdHadamardOp
+ * @brief Pair operation a' = (a+b)/√2, b' = (a-b)/√2 on registers of backend B
+ *
+ * Pair operations are called as op(B(), a, b) with a, b of type B::reg, so
+ * the same object serves the vector loop and the scalar tail.
+ */
+template <typename T>
+struct SimdHadamardOp
+{
+    T invSqrt2;
+    template <typename B>
+    void operator()(B, typename B::reg &a, typename B::reg &b) const
+    {
+        const typename B::reg s = B::Set1(invSqrt2);
+        const typename B::reg x = a;
+        a = B::Mul(B::Add(x, b), s);
+        b = B::Mul(B::Sub(x, b), s);
+    }
+};
+
+/**
+ * @struct SimdSwapOp
+ * @brief Pair operation (a, b) → (b, a) (Pauli-X)
+ */
+struct SimdSwapOp
+{
+    template <typename B>
+    void operator()(B, typename B::reg &a, typename B::reg &b) const
+    {
+        std::swap(a, b);
+    }
+};
+
+/**
+ * @struct SimdPauliYOp
+ * @brief Pair operation a' = -i·b, b' = i·a
+ *
+ * -i·(x + iy) = y - ix  → swap (re, im) then negate the imaginary lane
+ *  i·(x + iy) = -y + ix → swap (re, im) then negate the real lane
+ */
+struct SimdPauliYOp
+{
+    template <typename B>
+    void operator()(B, typename B::reg &a, typename B::reg &b) const
+    {
+        const typename B::reg x = a;
+        a = B::NegIm(B::SwapReIm(b));
+        b = B::NegRe(B::SwapReIm(x));
+    }
+};
+
+/**
+ * @struct SimdPhaseOp
+ * @brief Pair operation a' = p0·a (only if scaleZero), b' = p1·b (diagonal gates)
+ */
+template <typename T>
+struct SimdPhaseOp
+{
+    std::complex<T> p0, p1;
+    bool scaleZero;
+    template <typename B>
+    void operator()(B, typename B::reg &a, typename B::reg &b) const
+    {
+        if (scaleZero)
+            a = B::CMul(a, p0.real(), p0.imag());
+        b = B::CMul(b, p1.real(), p1.imag());
+    }
+};
+
+/**
+ * @struct SimdMatrix2Op
+ * @brief Pair operation a' = u00·a + u01·b, b' = u10·a + u11·b
+ */
+template <typename T>
+struct SimdMatrix2Op
+{
+    const std::complex<T> (&u)[4];              ///< Row-major entries {u00, u01, u10, u11}
+    template <typename B>
+    void operator()(B, typename B::reg &a, typename B::reg &b) const
+    {
+        const typename B::reg x = a;
+        a = B::Add(B::CMul(x, u[0].real(), u[0].imag()), B::CMul(b, u[1].real(), u[1].imag()));
+        b = B::Add(B::CMul(x, u[2].real(), u[2].imag()), B::CMul(b, u[3].real(), u[3].imag()));
+    }
+};
+
+/**
+ * @brief Apply a pair operation over two runs: (a[k], b[k]) for k < len
+ * @param a Run of amplitudes with target qubit = 0
+ * @param b Matching run with target qubit = 1
+ * @param len Number of complex amplitudes in each run
+ */
+template <typename T, typename Op>
+inline void SimdPairRun(std::complex<T> *a, std::complex<T> *b, size_t len, const Op &op)
+{
+    using V = SimdOf<T>;
+    using S = SimdScalarT<T>;
+    size_t k = 0;
+    for (; k + V::kComplexPerReg <= len; k += V::kComplexPerReg)
+    {
+        typename V::reg va = V::Load(a + k), vb = V::Load(b + k);
+        op(V(), va, vb);
+        V::Store(a + k, va);
+        V::Store(b + k, vb);
+    }
+    for (; k < len; ++k)
+    {
+        typename S::reg va = S::Load(a + k), vb = S::Load(b + k);
+        op(S(), va, vb);
+        S::Store(a + k, va);
+        S::Store(b + k, vb);
+    }
+}
+
+/**
+ * @brief Apply a pair operation to the qubit-Q pairs of a contiguous span, whole registers at a time
+ * @tparam Q Target qubit, 2^Q < kComplexPerReg
+ * @param amp First amplitude (index a multiple of 2^(Q+1))
+ * @param len Span length, a multiple of 2^(Q+1)
+ */
+template <int Q, typename T, typename Op>
+inline void SimdLowPairRunQ(std::complex<T> *amp, size_t len, const Op &op)
+{
+    using V = SimdOf<T>;
+    using S = SimdScalarT<T>;
+    constexpr size_t lanes = V::kComplexPerReg, half = size_t(1) << Q;
+    size_t k = 0;
+    if constexpr (half < lanes)
+    {
+        for (; k + 2 * lanes <= len; k += 2 * lanes)
+        {
+            typename V::reg x = V::Load(amp + k), y = V::Load(amp + k + lanes), a, b;
+            V::template SplitPairs<Q>(x, y, a, b);
+            op(V(), a, b);
+            V::template MergePairs<Q>(a, b, x, y);
+            V::Store(amp + k, x);
+            V::Store(amp + k + lanes, y);
+        }
+    }
+    for (; k < len; k += 2 * half)
+    {
+        for (size_t j = 0; j < half; ++j)
+        {
+            typename S::reg a = S::Load(amp + k + j), b = S::Load(amp + k + j + half);
+            op(S(), a, b);
+            S::Store(amp + k + j, a);
+            S::Store(amp + k + j + half, b);
+        }
+    }
+}
+
+/**
+ * @brief Largest target qubit whose runs are shorter than a register of SimdOf<T>
+ * @return -1 if every run fills whole registers (scalar backend)
+ */
+template <typename T>
+constexpr int SimdLowQubitLimit()
+{
+    int q = -1;
+    while ((size_t(1) << (q + 1)) < SimdOf<T>::kComplexPerReg)
+        ++q;
+    return q;
+}
+
+/**
+ * @brief Runtime-qubit form of SimdLowPairRunQ: qubit ≤ SimdLowQubitLimit<T>()
+ */
+template <typename T, typename Op>
+inline void SimdLowPairRun(std::complex<T> *amp, size_t len, int qubit, const Op &op)
+{
+    if (qubit == 0)
+        SimdLowPairRunQ<0>(amp, len, op);
+    else if (qubit == 1)
+        SimdLowPairRunQ<1>(amp, len, op);
+    else
+        SimdLowPairRunQ<2>(amp, len, op);
+}
+
+/**
+ * @brief Hadamard butterfly over two runs: a' = (a+b)/√2, b' = (a-b)/√2
+ * @param a Run of amplitudes with target qubit = 0
+ * @param b Matching run with target qubit = 1
+ * @param len Number of complex amplitudes in each run
+ */
+template <typename T>
+inline void SimdHadamardRun(std::complex<T> *a, std::complex<T> *b, size_t len, T invSqrt2)
+{
+    SimdPairRun(a, b, len, SimdHadamardOp<T>{invSqrt2});
+}
+
+/**
+ * @brief Pauli-X over two runs: swap a and b
+ */
+template <typename T>
+inline void SimdSwapRun(std::complex<T> *a, std::complex<T> *b, size_t len)
+{
+    SimdPairRun(a, b, len, SimdSwapOp());
+}
+
+/**
+ * @brief Pauli-Y over two runs: a' = -i·b, b' = i·a
+ */
+template <typename T>
+inline void SimdPauliYRun(std::complex<T> *a, std::complex<T> *b, size_t len)
+{
+    SimdPairRun(a, b, len, SimdPauliYOp());
+}
+
+/**
+ * @brief Diagonal phase on the target=1 run: b' = phase·b (Z, S, T gates)
+ * @param b Run of amplitudes with target qubit = 1 (the |0⟩ half is untouched)
+ */
+template <typename T>
+inline void SimdPhaseRun(std::complex<T> *b, size_t len, std::complex<T> phase)
+{
+    using V = SimdOf<T>;
+    using S = SimdScalarT<T>;
+    const T pr = phase.real(), pi = phase.imag();
+    size_t k = 0;
+    for (; k + V::kComplexPerReg <= len; k += V::kComplexPerReg)
+        V::Store(b + k, V::CMul(V::Load(b + k), pr, pi));
+    for (; k < len; ++k)
+        S::Store(b + k, S::CMul(S::Load(b + k), pr, pi));
+}
+
+/**
+ * @brief General 2×2 unitary over two runs: a' = u00·a + u01·b, b' = u10·a + u11·b
+ * @param u Row-major matrix entries {u00, u01, u10, u11}
+ */
+template <typename T>
+inline void SimdMatrix2Run(std::complex<T> *a, std::complex<T> *b, size_t len, const std::complex<T> (&u)[4])
+{
+    SimdPairRun(a, b, len, SimdMatrix2Op<T>{u});
+}
+
+/**
+ * @brief Σ |vᵢ|² over a contiguous amplitude range
+ *
+ * Squares and accumulates every scalar (re² + im²) with two independent
+ * accumulators to hide add latency, flushing them into a double total every
+ * kReduceBlock amplitudes.
+ */
+template <typename T>
+inline double SimdNormSum(const std::complex<T> *v, size_t len)
+{
+    using V = SimdOf<T>;
+    size_t k = 0;
+    double result = 0.0;
+    while (k + 2 * V::kComplexPerReg <= len)
+    {
+        const size_t blockEnd = std::min(len, k + kReduceBlock);
+        typename V::reg acc0 = V::Zero(), acc1 = V::Zero();
+        for (; k + 2 * V::kComplexPerReg <= blockEnd; k += 2 * V::kComplexPerReg)
+        {
+            typename V::reg x0 = V::Load(v + k), x1 = V::Load(v + k + V::kComplexPerReg);
+            acc0 = V::Add(acc0, V::Mul(x0, x0));
+            acc1 = V::Add(acc1, V::Mul(x1, x1));
+        }
+        result += V::Sum(V::Add(acc0, acc1));
+    }
+    for (; k < len; ++k)
+        result += double(std::norm(v[k]));
+    return result;
+}
+
+/**
+ * @brief Σ conj(aᵢ)·bᵢ over contiguous ranges
+ *
+ * conj(a)·b = (ar·br + ai·bi) + i(ar·bi - ai·br)
+ * - real part: sum of all lanes of a·b
+ * - imag part: a·swap(b) = [ar·bi, ai·br], negate odd lanes, sum
+ */
+template <typename T>
+inline std::complex<double> SimdInnerProduct(const std::complex<T> *a, const std::complex<T> *b, size_t len)
+{
+    using V = SimdOf<T>;
+    size_t k = 0;
+    double sumRe = 0.0, sumIm = 0.0;
+    while (k + V::kComplexPerReg <= len)
+    {
+        const size_t blockEnd = std::min(len, k + kReduceBlock);
+        typename V::reg re = V::Zero(), im = V::Zero();
+        for (; k + V::kComplexPerReg <= blockEnd; k += V::kComplexPerReg)
+        {
+            typename V::reg va = V::Load(a + k), vb = V::Load(b + k);
+            re = V::Add(re, V::Mul(va, vb));
+            im = V::Add(im, V::NegIm(V::Mul(va, V::SwapReIm(vb))));
+        }
+        sumRe += V::Sum(re);
+        sumIm += V::Sum(im);
+    }
+    std::complex<double> result(sumRe, sumIm);
+    for (; k < len; ++k)
+        result += std::conj(std::complex<double>(a[k])) * std::complex<double>(b[k]);
+    return result;
+}
+
+/**
+ * @struct Overlap
+ * @brief Result of the fused overlap kernel: ⟨a|b⟩, ⟨a|a⟩ and ⟨b|b⟩
+ */
+struct Overlap
+{
+    std::complex<double> inner{0.0, 0.0};   ///< Σ conj(aᵢ)·bᵢ
+    double normA = 0.0;                     ///< Σ |aᵢ|²
+    double normB = 0.0;                     ///< Σ |bᵢ|²
+
+    Overlap &operator+=(const Overlap &o)
+    {
+        inner += o.inner;
+        normA += o.normA;
+        normB += o.normB;
+        return *this;
+    }
+};
+
+/**
+ * @brief ⟨a|b⟩, ⟨a|a⟩ and ⟨b|b⟩ in a single pass over both ranges
+ *
+ * Fidelity |⟨a|b⟩|² / (⟨a|a⟩⟨b|b⟩) needs all three; computing them together
+ * reads each amplitude once instead of three times.
+ */
+template <typename T>
+inline Overlap SimdOverlap(const std::complex<T> *a, const std::complex<T> *b, size_t len)
+{
+    using V = SimdOf<T>;
+    size_t k = 0;
+    Overlap result;
+    double sumRe = 0.0, sumIm = 0.0;
+    while (k + V::kComplexPerReg <= len)
+    {
+        const size_t blockEnd = std::min(len, k + kReduceBlock);
+        typename V::reg re = V::Zero(), im = V::Zero(), na = V::Zero(), nb = V::Zero();
+        for (; k + V::kComplexPerReg <= blockEnd; k += V::kComplexPerReg)
+        {
+            typename V::reg va = V::Load(a + k), vb = V::Load(b + k);
+            re = V::Add(re, V::Mul(va, vb));
+            im = V::Add(im, V::NegIm(V::Mul(va, V::SwapReIm(vb))));
+            na = V::Add(na, V::Mul(va, va));
+            nb = V::Add(nb, V::Mul(vb, vb));
+        }
+        sumRe += V::Sum(re);
+        sumIm += V::Sum(im);
+        result.normA += V::Sum(na);
+        result.normB += V::Sum(nb);
+    }
+    result.inner = std::complex<double>(sumRe, sumIm);
+    for (; k < len; ++k)
+    {
+        std::complex<double> x(a[k]), y(b[k]);
+        result.inner += std::conj(x) * y;
+        result.normA += std::norm(x);
+        result.normB += std::norm(y);
+    }
+    return result;
+}
+
+#endif // SIMD_CL_CPP
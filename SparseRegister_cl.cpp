@@ -0,0 +1,476 @@
+/**
+ * @file SparseRegister_cl.cpp
+ * @brief Sparse state-vector backend with automatic promotion to a dense Register
+ *
+ * A register prepared from a few bitstrings — or driven by X, CNOT, Toffoli,
+ * SWAP and phase gates only — keeps a handful of non-zero amplitudes for most
+ * of a circuit, yet Register always stores all 2^n of them. SparseRegister
+ * stores only the non-zeros, keyed by basis index:
+ *
+ *     amplitudes = { i → αᵢ : αᵢ ≠ 0 }
+ *
+ * Gate cost then scales with the number of non-zeros m instead of 2^n:
+ * - Diagonal gates (Z, S, T, phase, CZ): scale the stored values in place
+ * - Permutation gates (X, Y, CNOT, Toffoli, SWAP): re-key each entry, m stays
+ * - Mixing gates (H, general U): each stored pair (i, i ⊕ 2^q) becomes up to
+ *   two entries, so m at most doubles; exact cancellations are dropped
+ *
+ * This makes 40- to 60-qubit circuits with low "fill" feasible: a 50-qubit
+ * GHZ state holds 2 entries instead of 2^50 × 16 bytes.
+ *
+ * Promotion:
+ * Hash-map entries cost several times a dense amplitude, so once m exceeds a
+ * fill fraction of 2^n (kSparsePromoteFill by default) and the dense state fits
+ * the memory budget, the register converts itself into an ordinary Register
+ * and from then on forwards every call to the dense kernels. Promotion is one
+ * way; use ToRegister() or Dense() to hand the state to dense-only code.
+ *
+ * Usage:
+ * SparseRegister ghz(48);
+ * ghz.ApplyGate(HadamardR(), 47);
+ * for (int q = 46; q >= 0; --q)
+ *     ghz.ApplyGate(CNotGateR(q + 1), q);     // Still 2 non-zeros
+ * auto counts = ghz.Sample(1000);             // ~500 × |0...0⟩, ~500 × |1...1⟩
+ *
+ * Precision: double (complex<double>), like RegisterSoA.
+ *
+ * @author Your Name
+ * @date 2025
+ */
+
+#ifndef SPARSE_REGISTER_CL_CPP
+#define SPARSE_REGISTER_CL_CPP
+
+#include <algorithm>
+#include <cassert>
+#include <map>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "RegisterGates_cl.cpp"
+
+/// Default fill fraction (non-zeros / 2^n) above which a sparse register turns dense
+constexpr double kSparsePromoteFill = 1.0 / 8.0;
+
+/// Entries with |α|² below this are treated as exact cancellations and dropped (|α| < 1e-15)
+constexpr double kSparseDropNorm = 1e-30;
+
+/**
+ * @class SparseRegister
+ * @brief Quantum register storing only non-zero amplitudes until it becomes dense
+ *
+ * Mirrors the Register measurement API (MeasureIndex, CollapseIndex, Sample,
+ * Print, ...) so code can switch backends without restructuring; gates are
+ * applied through ApplyGate (any RGates with a fixed Matrix(), or a
+ * ControlledGateR) or the ApplyMatrix / ApplyControlled / ApplySwap primitives.
+ */
+class SparseRegister
+{
+public:
+    using Amplitude = COMPLEX<double>;              ///< Stored amplitude type
+    using RandomEngine = Register::RandomEngine;    ///< Engine type driving measurement draws
+
+    int bits;                                       ///< Number of qubits in the register
+
+    /**
+     * @brief Create an n-qubit register in |00...0⟩ (one stored amplitude)
+     * @param n Number of qubits (1 to 63); no 2^n allocation takes place
+     * @param promoteFill Fill fraction that triggers promotion to dense
+     */
+    explicit SparseRegister(int n, double promoteFill = kSparsePromoteFill) : bits(n), promoteFill(promoteFill)
+    {
+        assert(n >= 1 && n <= 63 && "Sparse registers span 1 to 63 qubits");
+        amplitudes.emplace(0, Amplitude(1, 0));
+    }
+
+    /**
+     * @brief Create a register from a few basis-state amplitudes (normalised)
+     * @param n Number of qubits
+     * @param initStates Map from n-character bitstrings to amplitudes, as for Register
+     * @param promoteFill Fill fraction that triggers promotion to dense
+     *
+     * Example: SparseRegister reg(40, {{std::string(40, '0'), 1.0}, {std::string(40, '1'), 1.0}});
+     */
+    SparseRegister(int n, const std::map<std::string, Amplitude> &initStates,
+                   double promoteFill = kSparsePromoteFill)
+        : bits(n), promoteFill(promoteFill)
+    {
+        assert(n >= 1 && n <= 63 && "Sparse registers span 1 to 63 qubits");
+        double norm = 0.0;
+        for (const auto &[bitstring, amplitude] : initStates)
+        {
+            assert(static_cast<int>(bitstring.length()) == n && "Bitstring length must match register size");
+            if (std::norm(amplitude) < kSparseDropNorm)
+                continue;
+            amplitudes[std::stoull(bitstring, nullptr, 2)] = amplitude;
+            norm += std::norm(amplitude);
+        }
+        assert(norm > 0.0 && "Initial state must have a non-zero amplitude");
+        const double scale = 1.0 / std::sqrt(norm);
+        for (auto &entry : amplitudes)
+            entry.second *= scale;
+        MaybePromote();
+    }
+
+    /**
+     * @brief Whether the register has been promoted to a dense Register
+     */
+    bool IsDense() const
+    {
+        return dense.has_value();
+    }
+
+    /**
+     * @brief Number of stored amplitudes (2^n once dense)
+     */
+    uint64_t NonZeros() const
+    {
+        return dense ? dense->val.size() : amplitudes.size();
+    }
+
+    /**
+     * @brief Apply a fixed single-qubit gate (H, X, Y, Z, S, T, MatrixGateR, ...)
+     * @param gate Gate providing its 2×2 matrix via RGates::Matrix()
+     * @param qubitIndex Target qubit
+     * @throws std::invalid_argument if the gate has no matrix (controlled gates take the overload below)
+     */
+    void ApplyGate(const RGates &gate, int qubitIndex)
+    {
+        if (dense)
+        {
+            gate.ApplyToSingle(*dense, qubitIndex);
+            return;
+        }
+        ApplyControlled(qubitIndex, 0, FixedMatrix(gate));
+    }
+
+    /**
+     * @brief Apply a controlled gate (CNotGateR, CZGateR, ToffoliGateR, ...) with the given target
+     */
+    void ApplyGate(const ControlledGateR &gate, int qubitIndex)
+    {
+        ApplyControlled(qubitIndex, gate.ControlMask(), gate.TargetMatrix());
+    }
+
+    /**
+     * @brief Apply an arbitrary 2×2 unitary to one qubit
+     */
+    void ApplyMatrix(int qubitIndex, const Matrix2 &u)
+    {
+        ApplyControlled(qubitIndex, 0, u);
+    }
+
+    /**
+     * @brief Apply u to the target when every qubit in controlMask is |1⟩
+     * @param targetIndex Target qubit
+     * @param controlMask Control qubits (0 = uncontrolled)
+     * @param u Gate matrix
+     *
+     * Sparse algorithm by gate structure:
+     * - Diagonal: αᵢ *= u00 or u11 in place
+     * - Anti-diagonal (X, Y): entry i moves to i ⊕ 2^t, times u10 or u01
+     * - General: each pair (α₀, α₁) present in the map is mixed once and the
+     *   results with |β|² ≥ kSparseDropNorm are stored
+     *
+     * @complexity Time: O(m) for m stored amplitudes (dense: O(2^(n-k)))
+     */
+    void ApplyControlled(int targetIndex, uint64_t controlMask, const Matrix2 &u)
+    {
+        const uint64_t tmask = uint64_t(1) << targetIndex;
+        assert(targetIndex >= 0 && targetIndex < bits && !(controlMask & tmask));
+        if (dense)
+        {
+            ApplyControlledMatrix2(*dense, targetIndex, controlMask, u);
+            return;
+        }
+
+        if (u.IsDiagonal())
+        {
+            for (auto &[index, a] : amplitudes)
+            {
+                if ((index & controlMask) == controlMask)
+                    a *= (index & tmask) ? u.m[3] : u.m[0];
+            }
+            return;
+        }
+
+        Map next;
+        const bool antiDiagonal = std::abs(u.m[0]) < 1e-12 && std::abs(u.m[3]) < 1e-12;
+        next.reserve(antiDiagonal ? amplitudes.size() : 2 * amplitudes.size());
+        for (const auto &[index, a] : amplitudes)
+        {
+            if ((index & controlMask) != controlMask)
+            {
+                next.emplace(index, a);                     // Controls not satisfied: unchanged
+                continue;
+            }
+            if (antiDiagonal)
+            {
+                next.emplace(index ^ tmask, a * ((index & tmask) ? u.m[1] : u.m[2]));
+                continue;
+            }
+            const uint64_t base = index & ~tmask;
+            if ((index & tmask) && amplitudes.count(base))
+                continue;                                   // Pair handled from its |0⟩ member
+            const Amplitude a0 = Find(base), a1 = Find(base | tmask);
+            Store(next, base, u.m[0] * a0 + u.m[1] * a1);
+            Store(next, base | tmask, u.m[2] * a0 + u.m[3] * a1);
+        }
+        amplitudes.swap(next);
+        MaybePromote();
+    }
+
+    /**
+     * @brief Exchange two qubit positions (pure re-keying of the stored entries)
+     */
+    void ApplySwap(int qubitA, int qubitB)
+    {
+        assert(qubitA != qubitB && "Swap needs two distinct qubits");
+        if (dense)
+        {
+            ::ApplySwap(*dense, qubitA, qubitB);
+            return;
+        }
+        const uint64_t maskA = uint64_t(1) << qubitA, maskB = uint64_t(1) << qubitB;
+        Map next;
+        next.reserve(amplitudes.size());
+        for (const auto &[index, a] : amplitudes)
+        {
+            const bool differ = ((index & maskA) != 0) != ((index & maskB) != 0);
+            next.emplace(differ ? index ^ maskA ^ maskB : index, a);
+        }
+        amplitudes.swap(next);
+    }
+
+    /**
+     * @brief Amplitude of basis state |i⟩ (0 if not stored)
+     */
+    Amplitude GetAmplitude(uint64_t i) const
+    {
+        return dense ? dense->val[i] : Find(i);
+    }
+
+    /**
+     * @brief Born-rule probability of basis state |i⟩
+     */
+    double GetProbab(uint64_t i) const
+    {
+        return std::norm(GetAmplitude(i));
+    }
+
+    /**
+     * @brief Σ |αᵢ|² over the stored amplitudes
+     * @complexity Time: O(m), Space: O(1)
+     */
+    double MagnitudeSquareSum() const
+    {
+        if (dense)
+            return dense->MagnitudeSquareSum();
+        double total = 0.0;
+        for (const auto &entry : amplitudes)
+            total += std::norm(entry.second);
+        return total;
+    }
+
+    /**
+     * @brief Non-collapsing measurement returning the basis index
+     * @complexity Time: O(m log m) (entries are ordered so draws match index order)
+     */
+    uint64_t MeasureIndex()
+    {
+        if (dense)
+            return dense->MeasureIndex();
+        return Draw(SortedCumulative(), rng.UniformDouble());
+    }
+
+    /**
+     * @brief Collapsing measurement: the register becomes the single entry |i⟩
+     */
+    uint64_t CollapseIndex()
+    {
+        if (dense)
+            return dense->CollapseIndex();
+        uint64_t index = MeasureIndex();
+        amplitudes.clear();
+        amplitudes.emplace(index, Amplitude(1, 0));
+        return index;
+    }
+
+    std::string Collapse() { return IndexToBitstring(CollapseIndex()); }               ///< Collapse() as bitstring
+    std::string MeasureWithoutCollapse() { return IndexToBitstring(MeasureIndex()); }  ///< Peek as bitstring
+
+    /**
+     * @brief Draw many shots: cumulative table over the m non-zeros, built once
+     * @return Histogram mapping basis index → count (as Register::Sample)
+     * @complexity Time: O(m log m + shots·log m), Space: O(m)
+     */
+    std::map<uint64_t, size_t> Sample(size_t shots)
+    {
+        if (dense)
+            return dense->Sample(shots);
+        const auto cumulative = SortedCumulative();
+        std::map<uint64_t, size_t> histogram;
+        for (size_t shot = 0; shot < shots; ++shot)
+            ++histogram[Draw(cumulative, rng.UniformDouble())];
+        return histogram;
+    }
+
+    /**
+     * @brief Seed the measurement engine (carried over on promotion)
+     */
+    void Seed(uint64_t seed, uint64_t stream = 0)
+    {
+        if (dense)
+            dense->Seed(seed, stream);
+        else
+            rng.Seed(seed, stream);
+    }
+
+    /**
+     * @brief Print the state in Dirac notation, ascending basis order
+     */
+    void Print() const
+    {
+        if (dense)
+        {
+            dense->Print();
+            return;
+        }
+        std::vector<std::pair<uint64_t, Amplitude>> entries(amplitudes.begin(), amplitudes.end());
+        std::sort(entries.begin(), entries.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+        std::cout << "|ψ⟩ = ";
+        bool first = true;
+        for (const auto &[index, a] : entries)
+        {
+            if (std::abs(a) < 1e-6)
+                continue;
+            if (!first)
+                std::cout << " + ";
+            first = false;
+            std::cout << a << "|" << IndexToBitstring(index) << "⟩";
+        }
+        std::cout << std::endl;
+    }
+
+    /**
+     * @brief n-bit binary string of a basis index, MSB first (as Register)
+     */
+    std::string IndexToBitstring(uint64_t index) const
+    {
+        std::string result(bits, '0');
+        for (int j = 0; j < bits; ++j)
+        {
+            if ((index >> j) & 1)
+                result[bits - 1 - j] = '1';
+        }
+        return result;
+    }
+
+    /**
+     * @brief Promote now (if not yet dense) and access the dense register
+     * @throws std::length_error if the dense state exceeds the memory budget
+     */
+    Register &Dense()
+    {
+        if (!dense)
+            Promote();
+        return *dense;
+    }
+
+    /**
+     * @brief Dense copy of the state
+     * @throws std::length_error if the dense state exceeds the memory budget
+     */
+    Register ToRegister() const
+    {
+        if (dense)
+            return *dense;
+        Register reg(bits);
+        reg.val[0] = Amplitude(0, 0);
+        for (const auto &[index, a] : amplitudes)
+            reg.val[index] = a;
+        reg.MarkDirty();
+        return reg;
+    }
+
+private:
+    using Map = std::unordered_map<uint64_t, Amplitude>;
+
+    Map amplitudes;                                 ///< Non-zero amplitudes while sparse
+    std::optional<Register> dense;                  ///< Dense state after promotion
+    double promoteFill;                             ///< Fill fraction that triggers promotion
+    RandomEngine rng = RandomEngine::FromEntropy(); ///< Measurement engine while sparse
+
+    Amplitude Find(uint64_t index) const
+    {
+        auto it = amplitudes.find(index);
+        return it == amplitudes.end() ? Amplitude(0, 0) : it->second;
+    }
+
+    static void Store(Map &map, uint64_t index, Amplitude a)
+    {
+        if (std::norm(a) >= kSparseDropNorm)
+            map.emplace(index, a);
+    }
+
+    /**
+     * @brief Promote once the fill passes the threshold and the dense state fits the budget
+     */
+    void MaybePromote()
+    {
+        const double capacity = static_cast<double>(uint64_t(1) << bits);
+        if (static_cast<double>(amplitudes.size()) > promoteFill * capacity &&
+            RegisterBudget::FitsMemoryBudget(bits, sizeof(Amplitude)))
+        {
+            Promote();
+        }
+    }
+
+    /**
+     * @brief Scatter the stored entries into a new dense Register and free the map
+     */
+    void Promote()
+    {
+        dense.emplace(bits);
+        dense->val[0] = Amplitude(0, 0);
+        for (const auto &[index, a] : amplitudes)
+            dense->val[index] = a;
+        dense->Engine() = rng;
+        Map().swap(amplitudes);                     // Release the hash table's memory
+    }
+
+    /**
+     * @brief Stored entries in ascending index order with running Σ|α|²
+     */
+    std::vector<std::pair<uint64_t, double>> SortedCumulative() const
+    {
+        std::vector<std::pair<uint64_t, double>> table;
+        table.reserve(amplitudes.size());
+        for (const auto &[index, a] : amplitudes)
+            table.emplace_back(index, std::norm(a));
+        std::sort(table.begin(), table.end());
+        double total = 0.0;
+        for (auto &entry : table)
+        {
+            total += entry.second;
+            entry.second = total;
+        }
+        return table;
+    }
+
+    /**
+     * @brief First entry whose cumulative weight exceeds r·total
+     */
+    static uint64_t Draw(const std::vector<std::pair<uint64_t, double>> &cumulative, double r)
+    {
+        const double target = r * cumulative.back().second;
+        auto it = std::upper_bound(cumulative.begin(), cumulative.end(), target,
+                                   [](double t, const std::pair<uint64_t, double> &e) { return t < e.second; });
+        return it == cumulative.end() ? cumulative.back().first : it->first;
+    }
+};
+
+#endif // SPARSE_REGISTER_CL_CPP
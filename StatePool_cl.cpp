@@ -0,0 +1,378 @@
+/**
+ * @file StatePool_cl.cpp
+ * @brief Recycling, huge-page-aware pool for state vectors and measurement scratch
+ *
+ * A fresh 2^n state vector costs more than its allocation call: the kernel
+ * hands out untouched pages, and the first sweep over the state takes one
+ * page fault per 4 KiB (a 1 GiB state is 262144 faults). Programs that build
+ * and drop registers in a loop — parameter sweeps, services running one
+ * circuit per request — pay that on every register, and fragment the heap
+ * with multi-GB blocks on top.
+ *
+ * StatePool keeps released blocks on a free list per byte size (state
+ * vectors come in a handful of power-of-two sizes) and hands them back out,
+ * already faulted in, to the next request of the same size. Large blocks
+ * (≥ kHugePageBytes) are mapped 2 MiB aligned and marked MADV_HUGEPAGE on
+ * Linux, so transparent huge pages cut the faults and TLB misses of the
+ * first use by 512×. Blocks below kPoolMinBytes go straight through
+ * operator new: malloc already recycles those well.
+ *
+ * PoolAllocator<T> is the std::allocator handle: BasicRegister's state vector
+ * and its Sample() scratch use it, drawing from StatePool::Default() unless
+ * another pool is passed:
+ *
+ * StatePool pool;                                   // e.g. one per worker
+ * for(const auto &job : jobs){
+ *     Register reg(24, pool);                       // Recycled after the first job
+ *     ...
+ * }                                                 // Buffer returns to the pool
+ *
+ * The pool must outlive every register allocated from it.
+ *
+ * @author Your Name
+ * @date 2025
+ */
+
+#ifndef STATE_POOL_CL_CPP
+#define STATE_POOL_CL_CPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+/// Blocks smaller than this bypass the pool (64 KiB: below it malloc recycles well)
+constexpr uint64_t kPoolMinBytes = uint64_t(1) << 16;
+/// Blocks at least this large are mapped huge-page aligned (2 MiB, the x86-64 / AArch64 huge page)
+constexpr uint64_t kHugePageBytes = uint64_t(1) << 21;
+/// Default bytes kept on the free lists before released blocks are returned to the OS
+constexpr uint64_t kStatePoolCacheBytes = uint64_t(1) << 32;
+
+/**
+ * @class StatePool
+ * @brief Thread-safe cache of released amplitude and scratch buffers, keyed by size
+ */
+class StatePool
+{
+public:
+    /**
+     * @brief Pool with the given free-list capacity
+     * @param cacheLimit Most bytes held on the free lists (0 = cache nothing)
+     */
+    explicit StatePool(uint64_t cacheLimit = kStatePoolCacheBytes) : cacheLimit(cacheLimit) {}
+
+    StatePool(const StatePool &) = delete;
+    StatePool &operator=(const StatePool &) = delete;
+
+    ~StatePool()
+    {
+        Trim();
+    }
+
+    /**
+     * @brief Process-wide pool used by default-constructed PoolAllocators
+     */
+    static StatePool &Default()
+    {
+        static StatePool pool;
+        return pool;
+    }
+
+    /**
+     * @brief Get a block of at least bytes bytes, 64-byte aligned
+     * @throws std::bad_alloc if the system is out of memory
+     *
+     * Reuses a cached block of exactly this size when there is one. Its
+     * contents are whatever the previous owner left.
+     */
+    void *Allocate(uint64_t bytes)
+    {
+        if (bytes >= kPoolMinBytes)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = freeBlocks.find(bytes);
+            if (it != freeBlocks.end() && !it->second.empty())
+            {
+                void *block = it->second.back();
+                it->second.pop_back();
+                cachedBytes -= bytes;
+                ++hits;
+                return block;
+            }
+            ++misses;
+        }
+        return SystemAllocate(bytes);
+    }
+
+    /**
+     * @brief Give a block back (to the free list, or to the OS once the cache is full)
+     * @param block Pointer from Allocate(bytes)
+     * @param bytes The size passed to Allocate
+     */
+    void Release(void *block, uint64_t bytes)
+    {
+        if (bytes >= kPoolMinBytes)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (cachedBytes + bytes <= cacheLimit)
+            {
+                try
+                {
+                    freeBlocks[bytes].push_back(block);
+                    cachedBytes += bytes;
+                    return;
+                }
+                catch (const std::bad_alloc &)
+                {
+                    // No room for the free-list entry: release the block instead
+                }
+            }
+        }
+        SystemRelease(block, bytes);
+    }
+
+    /**
+     * @brief Return every cached block to the OS
+     */
+    void Trim()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto &[bytes, blocks] : freeBlocks)
+        {
+            for (void *block : blocks)
+                SystemRelease(block, bytes);
+        }
+        freeBlocks.clear();
+        cachedBytes = 0;
+    }
+
+    /**
+     * @brief Change the free-list capacity (trims if the cache is now over it)
+     */
+    void SetCacheLimit(uint64_t bytes)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            cacheLimit = bytes;
+            if (cachedBytes <= cacheLimit)
+                return;
+        }
+        Trim();
+    }
+
+    /**
+     * @brief Bytes currently held on the free lists
+     */
+    uint64_t CachedBytes() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return cachedBytes;
+    }
+
+    /**
+     * @brief Pooled-size requests served from the free lists
+     */
+    uint64_t Hits() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return hits;
+    }
+
+    /**
+     * @brief Pooled-size requests that had to go to the OS
+     */
+    uint64_t Misses() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return misses;
+    }
+
+private:
+    mutable std::mutex mutex;
+    std::map<uint64_t, std::vector<void *>> freeBlocks;     ///< Byte size → cached blocks
+    uint64_t cacheLimit;
+    uint64_t cachedBytes = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+
+    /**
+     * @brief Fresh block from the OS: huge-page aligned mapping or aligned operator new
+     */
+    static void *SystemAllocate(uint64_t bytes)
+    {
+#if defined(__linux__)
+        if (bytes >= kHugePageBytes)
+        {
+            // Over-map by one huge page, then unmap the unaligned head and the tail
+            const uint64_t length = RoundToHugePage(bytes);
+            void *raw = mmap(nullptr, length + kHugePageBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (raw == MAP_FAILED)
+                throw std::bad_alloc();
+            const uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+            const uintptr_t aligned = (start + kHugePageBytes - 1) & ~uintptr_t(kHugePageBytes - 1);
+            if (aligned > start)
+                munmap(raw, aligned - start);
+            const uintptr_t tail = start + length + kHugePageBytes - (aligned + length);
+            if (tail)
+                munmap(reinterpret_cast<void *>(aligned + length), tail);
+#if defined(MADV_HUGEPAGE)
+            madvise(reinterpret_cast<void *>(aligned), length, MADV_HUGEPAGE);   // Advisory; ignored without THP
+#endif
+            return reinterpret_cast<void *>(aligned);
+        }
+#endif
+        return ::operator new(bytes, std::align_val_t(64));
+    }
+
+    static void SystemRelease(void *block, uint64_t bytes)
+    {
+#if defined(__linux__)
+        if (bytes >= kHugePageBytes)
+        {
+            munmap(block, RoundToHugePage(bytes));
+            return;
+        }
+#endif
+        ::operator delete(block, std::align_val_t(64));
+    }
+
+    static uint64_t RoundToHugePage(uint64_t bytes)
+    {
+        return (bytes + kHugePageBytes - 1) & ~(kHugePageBytes - 1);
+    }
+};
+
+/**
+ * @class PoolAllocator
+ * @brief std::allocator-compatible handle drawing from a StatePool
+ * @tparam T Element type
+ *
+ * Stateful: containers copied from one another share the pool (including
+ * copy construction), and containers on different pools never compare equal,
+ * so moves between them copy rather than steal.
+ *
+ * Elements are value-initialised as with std::allocator. Owners that
+ * overwrite a whole block anyway (a register zero-filling its state in
+ * parallel, a permutation scattering into scratch) size it with
+ * ResizeUninitialised() instead.
+ */
+template <typename T>
+class PoolAllocator;
+
+template <typename T>
+void ResizeUninitialised(std::vector<T, PoolAllocator<T>> &v, size_t n);
+
+/**
+ * @brief Per-thread switch read by PoolAllocator::construct, set only by ResizeUninitialised()
+ */
+class PoolValueInit
+{
+    template <typename>
+    friend class PoolAllocator;
+    template <typename T>
+    friend void ResizeUninitialised(std::vector<T, PoolAllocator<T>> &v, size_t n);
+
+    static inline thread_local bool skip = false;
+};
+
+template <typename T>
+class PoolAllocator
+{
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    /**
+     * @brief Handle on StatePool::Default()
+     */
+    PoolAllocator() noexcept : pool(&StatePool::Default()) {}
+
+    /**
+     * @brief Handle on a caller-owned pool (implicit, so Register(n, pool) reads naturally)
+     */
+    PoolAllocator(StatePool &statePool) noexcept : pool(&statePool) {}
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U> &other) noexcept : pool(other.Pool()) {}
+
+    T *allocate(size_t n)
+    {
+        return static_cast<T *>(pool->Allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T *p, size_t n) noexcept
+    {
+        pool->Release(p, n * sizeof(T));
+    }
+
+    /**
+     * @brief Value-initialisation, skipped for trivially destructible U inside ResizeUninitialised()
+     */
+    template <typename U>
+    void construct(U *p) noexcept(std::is_nothrow_default_constructible<U>::value)
+    {
+        if constexpr (std::is_trivially_destructible<U>::value)
+        {
+            if (PoolValueInit::skip)
+                return;
+        }
+        ::new (static_cast<void *>(p)) U();
+    }
+
+    template <typename U, typename... Args>
+    void construct(U *p, Args &&...args)
+    {
+        ::new (static_cast<void *>(p)) U(std::forward<Args>(args)...);
+    }
+
+    PoolAllocator select_on_container_copy_construction() const
+    {
+        return *this;
+    }
+
+    StatePool *Pool() const noexcept
+    {
+        return pool;
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U> &other) const noexcept { return pool == other.Pool(); }
+    template <typename U>
+    bool operator!=(const PoolAllocator<U> &other) const noexcept { return pool != other.Pool(); }
+
+private:
+    StatePool *pool;
+};
+
+/**
+ * @brief Resize a pooled vector, leaving new trivially destructible elements unwritten
+ * @param v Vector to resize
+ * @param n New size
+ *
+ * For owners that overwrite every new element before reading it: the block
+ * can then be filled in parallel, so its pages are first touched by the
+ * threads that work on them. Existing elements are kept (moved on
+ * reallocation) and non-trivial element types are value-initialised as usual.
+ */
+template <typename T>
+void ResizeUninitialised(std::vector<T, PoolAllocator<T>> &v, size_t n)
+{
+    struct Scope
+    {
+        Scope() { PoolValueInit::skip = true; }
+        ~Scope() { PoolValueInit::skip = false; }   // Also if resize() throws
+    } scope;
+    v.resize(n);
+}
+
+#endif // STATE_POOL_CL_CPP
@@ -0,0 +1,296 @@
+/**
+ * @file StaticGates_cl.cpp
+ * @brief Compile-time specialised single-qubit kernels for small registers
+ *
+ * The register gates (RegisterGates_cl.cpp) are built for large states: the
+ * target qubit is a runtime argument, the pairs are enumerated as runs and
+ * handed to the thread pool and the SIMD run kernels. For a few-qubit
+ * register that machinery is the whole cost. On qubit 0, for instance,
+ * every run is one pair long and goes through the scalar tail of a run
+ * kernel.
+ *
+ * Here the gate, the target qubit, the register width and the control mask
+ * are template parameters:
+ *
+ *     ApplyStatic<StaticHadamard, 1, 2>(reg);               // H on qubit 1 of a 2-qubit register
+ *     ApplyStatic<StaticPauliX, 0, 2, 0b10>(reg);           // CNOT, control 1 → target 0
+ *
+ * so every loop bound and stride is a constant: the block loop has a fixed
+ * trip count, each block is one run of exactly 2^Target pairs — whole SIMD
+ * registers with no scalar tail once 2^Target covers the vector width, a
+ * plain unrolled pair loop below it — and controls are tested against a
+ * constant mask. Gates are tag types with a static Pair(a, b) update and a
+ * Run<Len>(a, b) over contiguous pairs: StaticHadamard, StaticPauliX,
+ * StaticPauliY, and StaticPhase<...> for StaticPauliZ, StaticS and StaticT.
+ *
+ * For registers whose width is only known at run time, ApplyStaticSmall()
+ * looks the specialisation up in a table of every (width, qubit) pair with
+ * width ≤ kStaticGateMaxQubits. HadamardR, XGateR, YGateR, ZGateR, SGateR
+ * and TGateR go through it, so small registers pick the specialised loops
+ * up with no change at the call site.
+ *
+ * @author Your Name
+ * @date 2025
+ */
+
+#ifndef STATIC_GATES_CL_CPP
+#define STATIC_GATES_CL_CPP
+
+#include <array>
+#include <cassert>
+#include <complex>
+#include <cstdint>
+#include <utility>
+
+#include "Quantum_registers_cl.cpp"
+#include "Simd_cl.cpp"
+
+#define COMPLEX std::complex
+
+/// Widest register served by the specialised kernels: 2^12 amplitudes (64 KiB), where call overhead dominates
+constexpr int kStaticGateMaxQubits = 12;
+
+/**
+ * @brief Visit Len contiguous pairs: whole SIMD registers if Len is a multiple of the width, else pair by pair
+ * @param vec Callable vec(a, b) updating one register's worth of pairs
+ * @param pair Callable pair(a, b) updating one pair
+ *
+ * Len is a constant, so exactly one branch is compiled and there is no tail.
+ */
+template <uint64_t Len, typename T, typename Vec, typename Pair>
+inline void StaticRun(COMPLEX<T> *a, COMPLEX<T> *b, Vec &&vec, Pair &&pair)
+{
+    constexpr uint64_t lanes = SimdOf<T>::kComplexPerReg;
+    if constexpr (Len % lanes == 0)
+    {
+        for (uint64_t k = 0; k < Len; k += lanes)
+            vec(a + k, b + k);
+    }
+    else
+    {
+        for (uint64_t k = 0; k < Len; ++k)
+            pair(a[k], b[k]);
+    }
+}
+
+/// 1/√2 with the same rounding as 1/std::sqrt(2.0)
+constexpr double kStaticInvSqrt2 = 1.0 / 1.41421356237309504880;
+
+/**
+ * @struct StaticHadamard
+ * @brief H: (a, b) → ((a + b)/√2, (a − b)/√2)
+ */
+struct StaticHadamard
+{
+    template <typename T>
+    static void Pair(COMPLEX<T> &a, COMPLEX<T> &b)
+    {
+        const COMPLEX<T> x = a, y = b;
+        a = (x + y) * T(kStaticInvSqrt2);
+        b = (x - y) * T(kStaticInvSqrt2);
+    }
+
+    template <uint64_t Len, typename T>
+    static void Run(COMPLEX<T> *a, COMPLEX<T> *b)
+    {
+        using V = SimdOf<T>;
+        const typename V::reg s = V::Set1(T(kStaticInvSqrt2));
+        StaticRun<Len>(a, b, [s](COMPLEX<T> *x, COMPLEX<T> *y) {
+            typename V::reg vx = V::Load(x), vy = V::Load(y);
+            V::Store(x, V::Mul(V::Add(vx, vy), s));
+            V::Store(y, V::Mul(V::Sub(vx, vy), s));
+        }, Pair<T>);
+    }
+};
+
+/**
+ * @struct StaticPauliX
+ * @brief X: (a, b) → (b, a)
+ */
+struct StaticPauliX
+{
+    template <typename T>
+    static void Pair(COMPLEX<T> &a, COMPLEX<T> &b)
+    {
+        std::swap(a, b);
+    }
+
+    template <uint64_t Len, typename T>
+    static void Run(COMPLEX<T> *a, COMPLEX<T> *b)
+    {
+        using V = SimdOf<T>;
+        StaticRun<Len>(a, b, [](COMPLEX<T> *x, COMPLEX<T> *y) {
+            typename V::reg vx = V::Load(x), vy = V::Load(y);
+            V::Store(x, vy);
+            V::Store(y, vx);
+        }, Pair<T>);
+    }
+};
+
+/**
+ * @struct StaticPauliY
+ * @brief Y: (a, b) → (−i·b, i·a)
+ */
+struct StaticPauliY
+{
+    template <typename T>
+    static void Pair(COMPLEX<T> &a, COMPLEX<T> &b)
+    {
+        const COMPLEX<T> x = a;
+        a = COMPLEX<T>(b.imag(), -b.real());
+        b = COMPLEX<T>(-x.imag(), x.real());
+    }
+
+    template <uint64_t Len, typename T>
+    static void Run(COMPLEX<T> *a, COMPLEX<T> *b)
+    {
+        using V = SimdOf<T>;
+        StaticRun<Len>(a, b, [](COMPLEX<T> *x, COMPLEX<T> *y) {
+            typename V::reg vx = V::Load(x), vy = V::Load(y);
+            V::Store(x, V::NegIm(V::SwapReIm(vy)));
+            V::Store(y, V::NegRe(V::SwapReIm(vx)));
+        }, Pair<T>);
+    }
+};
+
+/**
+ * @struct StaticPhase
+ * @brief Diagonal gate (a, b) → (a, p·b) with p = Phase::kRe + i·Phase::kIm fixed at compile time
+ */
+template <typename Phase>
+struct StaticPhase
+{
+    template <typename T>
+    static void Pair(COMPLEX<T> &, COMPLEX<T> &b)
+    {
+        b = COMPLEX<T>(T(Phase::kRe) * b.real() - T(Phase::kIm) * b.imag(),
+                       T(Phase::kRe) * b.imag() + T(Phase::kIm) * b.real());
+    }
+
+    template <uint64_t Len, typename T>
+    static void Run(COMPLEX<T> *a, COMPLEX<T> *b)
+    {
+        using V = SimdOf<T>;
+        StaticRun<Len>(a, b, [](COMPLEX<T> *, COMPLEX<T> *y) {
+            V::Store(y, V::CMul(V::Load(y), T(Phase::kRe), T(Phase::kIm)));
+        }, Pair<T>);
+    }
+};
+
+struct StaticPhaseZ { static constexpr double kRe = -1.0, kIm = 0.0; };
+struct StaticPhaseS { static constexpr double kRe = 0.0, kIm = 1.0; };
+struct StaticPhaseT { static constexpr double kRe = kStaticInvSqrt2, kIm = kStaticInvSqrt2; };
+
+using StaticPauliZ = StaticPhase<StaticPhaseZ>;     ///< Z: (a, b) → (a, −b)
+using StaticS = StaticPhase<StaticPhaseS>;          ///< S: (a, b) → (a, i·b)
+using StaticT = StaticPhase<StaticPhaseT>;          ///< T: (a, b) → (a, e^(iπ/4)·b)
+
+/**
+ * @brief Apply Gate to qubit Target of a Width-qubit state, conditioned on Controls
+ * @tparam Gate Tag type with static Pair(a, b) and Run<Len>(a, b)
+ * @tparam Target Target qubit
+ * @tparam Width Number of qubits in the span (amp has 2^Width entries)
+ * @tparam Controls Control bitmask (target bit excluded); 0 = uncontrolled
+ * @param amp First amplitude
+ *
+ * One pass over the 2^Width / 2^(Target+1) blocks; uncontrolled gates hand
+ * each block's 2^Target contiguous pairs to Gate::Run<2^Target>, controlled
+ * ones visit the pairs one at a time. All trip counts are constants.
+ *
+ * @complexity Time: O(2^Width), Space: O(1)
+ */
+template <typename Gate, int Target, int Width, uint64_t Controls = 0, typename T>
+inline void ApplyStatic(COMPLEX<T> *amp)
+{
+    static_assert(Width >= 1 && Width <= 30, "Static kernels are for small registers");
+    static_assert(Target >= 0 && Target < Width, "Target qubit outside the register");
+    static_assert((Controls >> Width) == 0 && (Controls & (uint64_t(1) << Target)) == 0,
+                  "Controls must be register qubits other than the target");
+    constexpr uint64_t mask = uint64_t(1) << Target;
+    constexpr uint64_t size = uint64_t(1) << Width;
+    for (uint64_t block = 0; block < size; block += 2 * mask)
+    {
+        if constexpr (Controls == 0)
+        {
+            Gate::template Run<mask>(amp + block, amp + block + mask);  // One fixed-length run per block
+            continue;
+        }
+        for (uint64_t offset = 0; offset < mask; ++offset)
+        {
+            const uint64_t i = block | offset;
+            if constexpr (Controls != 0)
+            {
+                if ((i & Controls) != Controls)
+                    continue;
+            }
+            Gate::Pair(amp[i], amp[i | mask]);
+        }
+    }
+}
+
+/**
+ * @brief Register overload: Width must equal reg.bits
+ */
+template <typename Gate, int Target, int Width, uint64_t Controls = 0, typename T>
+inline void ApplyStatic(BasicRegister<T> &reg)
+{
+    assert(reg.bits == Width && "Register width differs from the static kernel");
+    ApplyStatic<Gate, Target, Width, Controls>(reg.val.data());
+    reg.MarkDirty(true);
+}
+
+/**
+ * @class StaticKernelTable
+ * @brief Every uncontrolled ApplyStatic<Gate, q, w> with w ≤ kStaticGateMaxQubits, indexed [w][q]
+ */
+template <typename Gate, typename T>
+class StaticKernelTable
+{
+public:
+    using Kernel = void (*)(COMPLEX<T> *);
+
+    static Kernel Get(int width, int target)
+    {
+        return table[width * kStaticGateMaxQubits + target];
+    }
+
+private:
+    static constexpr int kEntries = (kStaticGateMaxQubits + 1) * kStaticGateMaxQubits;
+
+    template <int Entry>
+    static constexpr Kernel Make()
+    {
+        constexpr int width = Entry / kStaticGateMaxQubits, target = Entry % kStaticGateMaxQubits;
+        if constexpr (target < width)
+            return &ApplyStatic<Gate, target, width, 0, T>;
+        else
+            return nullptr;
+    }
+
+    template <int... Entries>
+    static constexpr std::array<Kernel, kEntries> Build(std::integer_sequence<int, Entries...>)
+    {
+        return {{Make<Entries>()...}};
+    }
+
+    static constexpr std::array<Kernel, kEntries> table = Build(std::make_integer_sequence<int, kEntries>());
+};
+
+/**
+ * @brief Apply Gate through the specialised kernel if the span is small enough
+ * @param amp First amplitude of a 2^width span
+ * @param width Number of qubits in the span
+ * @param target Target qubit
+ * @return false (and nothing applied) if width > kStaticGateMaxQubits
+ */
+template <typename Gate, typename T>
+inline bool ApplyStaticSmall(COMPLEX<T> *amp, int width, int target)
+{
+    if (width > kStaticGateMaxQubits)
+        return false;
+    assert(target >= 0 && target < width && "Target qubit outside the register");
+    StaticKernelTable<Gate, T>::Get(width, target)(amp);
+    return true;
+}
+
+#endif // STATIC_GATES_CL_CPP
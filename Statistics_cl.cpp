@@ -0,0 +1,304 @@
+/**
+ * @file Statistics_cl.cpp
+ * @brief In-process measurement statistics: top-k states, total-variation distance, compact summaries
+ *
+ * The analysis path used to be: write every shot (or the whole histogram)
+ * as CSV, load it into pandas in plotter.py, count and rank there. For wide
+ * registers and millions of shots the text round-trip is most of the run.
+ * This module does the analysis next to the register instead:
+ *
+ * - Streaming counts: shots go into a MeasurementSink (packed indices, dense
+ *   or hashed histogram, no strings) and Summarise() takes sink.Counts()
+ * - TopStates(reg, k): the k most probable basis states of the exact state,
+ *   by partial selection over val (a bounded heap per cache-sized chunk in
+ *   parallel, then one selection over the chunk winners)
+ * - TotalVariationDistance(reg, counts): ½ Σᵢ |P(i) − count(i)/shots|
+ *   against the exact GetProbab() values, touching only observed states
+ * - HistogramSummary: shots, distinct states, the k most frequent outcomes,
+ *   mean and standard deviation per observed state (as plotter.py reports
+ *   them) and the TVD when a reference register is given
+ *
+ * HistogramSummary::WriteCSV() emits just the top-k rows in the
+ * Measurement,Count format plotter.py reads, so the plot script loads k
+ * rows instead of a full histogram or a per-shot log.
+ *
+ * Usage:
+ * MeasurementSink sink(reg.bits);
+ * RecordSamples(reg, 1000000, sink);
+ * HistogramSummary summary = Summarise(reg, sink.Counts(), 16);
+ * summary.Print(std::cout);                      // Totals, TVD, top states
+ * summary.WriteCSV("collapse_measurements.csv"); // 16 rows for plotter.py
+ *
+ * @author Your Name
+ * @date 2025
+ */
+
+#ifndef STATISTICS_CL_CPP
+#define STATISTICS_CL_CPP
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Quantum_registers_cl.cpp"
+#include "MeasurementSink_cl.cpp"
+
+/// Default number of states kept in a summary (rows plotter.py labels legibly)
+constexpr size_t kSummaryTopStates = 16;
+
+/**
+ * @struct StateProbability
+ * @brief Basis index with its exact Born-rule probability
+ */
+struct StateProbability
+{
+    uint64_t index;                 ///< Basis index (bit q = qubit q)
+    double probability;             ///< |α_index|²
+};
+
+/**
+ * @struct StateCount
+ * @brief Basis index with its observed count
+ */
+struct StateCount
+{
+    uint64_t index;                 ///< Basis index (bit q = qubit q)
+    size_t count;                   ///< Shots that returned it
+};
+
+/**
+ * @brief The k most probable basis states of the register
+ * @param reg Register to rank (not modified)
+ * @param k Number of states wanted (clamped to 2^n)
+ * @return Up to k states, most probable first; ties go to the lower index
+ *
+ * Each chunk of kAmplitudesPerReduceChunk amplitudes keeps its k best in a
+ * min-heap while the pool sweeps the state; the chunk winners are then
+ * reduced with nth_element and sorted. Nothing of size 2^n is allocated, and
+ * the result does not depend on the thread count.
+ *
+ * @complexity Time: O(2^n log k + (2^n / chunk)·k), Space: O((2^n / chunk)·k)
+ */
+template <typename T>
+std::vector<StateProbability> TopStates(const BasicRegister<T> &reg, size_t k)
+{
+    const uint64_t size = reg.val.size();
+    k = static_cast<size_t>(std::min<uint64_t>(k, size));
+    if (k == 0)
+        return {};
+    auto better = [](const StateProbability &a, const StateProbability &b) {
+        return a.probability != b.probability ? a.probability > b.probability : a.index < b.index;
+    };
+
+    const uint64_t chunk = kAmplitudesPerReduceChunk;
+    const uint64_t chunks = (size + chunk - 1) / chunk;
+    std::vector<std::vector<StateProbability>> winners(chunks);
+    const typename BasicRegister<T>::Amplitude *amp = reg.val.data();
+    ThreadPool::Instance().ParallelFor(chunks, 1, [&](uint64_t first, uint64_t last) {
+        for (uint64_t c = first; c < last; ++c)
+        {
+            std::vector<StateProbability> &heap = winners[c];   // Front = worst kept
+            heap.reserve(k);
+            const uint64_t end = std::min(size, (c + 1) * chunk);
+            for (uint64_t i = c * chunk; i < end; ++i)
+            {
+                const StateProbability candidate{i, double(std::norm(amp[i]))};
+                if (heap.size() < k)
+                {
+                    heap.push_back(candidate);
+                    std::push_heap(heap.begin(), heap.end(), better);
+                }
+                else if (better(candidate, heap.front()))
+                {
+                    std::pop_heap(heap.begin(), heap.end(), better);
+                    heap.back() = candidate;
+                    std::push_heap(heap.begin(), heap.end(), better);
+                }
+            }
+        }
+    });
+
+    std::vector<StateProbability> top;
+    for (const auto &w : winners)
+        top.insert(top.end(), w.begin(), w.end());
+    std::nth_element(top.begin(), top.begin() + (k - 1), top.end(), better);
+    top.resize(k);
+    std::sort(top.begin(), top.end(), better);
+    return top;
+}
+
+/**
+ * @brief The k most frequent outcomes of a histogram
+ * @param counts Basis index → count (Sample(), MeasurementSink::Counts())
+ * @param k Number of outcomes wanted
+ * @return Up to k outcomes, most frequent first; ties go to the lower index
+ *
+ * @complexity Time: O(m log k) for m observed states, Space: O(m)
+ */
+inline std::vector<StateCount> TopCounts(const std::map<uint64_t, size_t> &counts, size_t k)
+{
+    std::vector<StateCount> top;
+    top.reserve(counts.size());
+    for (const auto &[index, count] : counts)
+        top.push_back({index, count});
+    k = std::min(k, top.size());
+    std::partial_sort(top.begin(), top.begin() + k, top.end(), [](const StateCount &a, const StateCount &b) {
+        return a.count != b.count ? a.count > b.count : a.index < b.index;
+    });
+    top.resize(k);
+    return top;
+}
+
+/**
+ * @brief Total-variation distance between a sampled histogram and the exact distribution
+ * @param reg Register the shots were drawn from (its state, not collapsed)
+ * @param counts Basis index → count
+ * @return ½ Σᵢ |P(i) − count(i)/shots| in [0, 1]
+ *
+ * Unobserved states contribute P(i) each, which sums to 1 − Σ_observed P(i),
+ * so only the observed indices are looked up with GetProbab(). P(i) is
+ * taken relative to MagnitudeSquareSum() (cached), so the state need not be
+ * normalised.
+ *
+ * @complexity Time: O(m) for m observed states once the norm is cached, Space: O(1)
+ */
+template <typename T>
+double TotalVariationDistance(const BasicRegister<T> &reg, const std::map<uint64_t, size_t> &counts)
+{
+    uint64_t shots = 0;
+    for (const auto &entry : counts)
+        shots += entry.second;
+    assert(shots > 0 && "Histogram is empty");
+    const double total = reg.MagnitudeSquareSum();
+    double observedMass = 0.0, difference = 0.0;
+    for (const auto &[index, count] : counts)
+    {
+        assert(index < reg.val.size() && "Histogram index outside the register");
+        const double p = reg.GetProbab(index) / total;
+        observedMass += p;
+        difference += std::abs(p - double(count) / double(shots));
+    }
+    return 0.5 * (difference + std::max(0.0, 1.0 - observedMass));
+}
+
+/**
+ * @struct HistogramSummary
+ * @brief Compact description of a measurement histogram, sized for plotting
+ */
+struct HistogramSummary
+{
+    int bits = 0;                               ///< Register size n
+    uint64_t shots = 0;                         ///< Total shots
+    size_t distinct = 0;                        ///< Basis states observed at least once
+    double mean = 0.0;                          ///< Shots per observed state
+    double stddev = 0.0;                        ///< Sample standard deviation of the counts (as pandas .std())
+    StateCount least{0, 0};                     ///< Least frequent observed state (lowest index on ties)
+    std::vector<StateCount> top;                ///< Most frequent states, most frequent first
+    double tvd = std::numeric_limits<double>::quiet_NaN();   ///< Distance to the exact distribution (NaN = no reference)
+
+    /**
+     * @brief Write the top states in plotter.py's Measurement,Count format
+     * @param filename Output path (e.g., "collapse_measurements.csv")
+     * @return true if the file was written successfully
+     *
+     * Rows are in ascending index order, as in a full histogram file.
+     */
+    bool WriteCSV(const std::string &filename) const
+    {
+        std::map<uint64_t, size_t> rows;
+        for (const auto &s : top)
+            rows.emplace(s.index, s.count);
+        return WriteHistogramCSV(rows, bits, filename);
+    }
+
+    /**
+     * @brief Print the totals, TVD and top states (plotter.py's statistical summary)
+     */
+    void Print(std::ostream &out) const
+    {
+        out << "Shots: " << shots << ", distinct states: " << distinct << '\n';
+        if (distinct == 0)
+            return;
+        out << "Most frequent state: " << Bitstring(top.front().index) << " (" << top.front().count << " occurrences)\n"
+            << "Least frequent state: " << Bitstring(least.index) << " (" << least.count << " occurrences)\n"
+            << std::fixed << std::setprecision(2)
+            << "Average measurements per state: " << mean << '\n'
+            << "Standard deviation: " << stddev << '\n';
+        if (!std::isnan(tvd))
+            out << std::setprecision(4) << "Total variation distance: " << tvd << '\n';
+        out << std::setprecision(4);
+        for (const auto &s : top)
+            out << "P(|" << Bitstring(s.index) << "⟩) = " << double(s.count) / double(shots)
+                << " (" << s.count << "/" << shots << ")\n";
+        out << std::defaultfloat << std::setprecision(6);
+    }
+
+private:
+    std::string Bitstring(uint64_t index) const
+    {
+        std::string s(bits, '0');
+        for (int j = 0; j < bits; ++j)
+        {
+            if ((index >> j) & 1)
+                s[bits - 1 - j] = '1';          // Bit j at position n-1-j
+        }
+        return s;
+    }
+};
+
+/**
+ * @brief Summarise a histogram
+ * @param counts Basis index → count
+ * @param bits Register size n
+ * @param k Number of most frequent states kept
+ *
+ * @complexity Time: O(m log k) for m observed states, Space: O(m)
+ */
+inline HistogramSummary Summarise(const std::map<uint64_t, size_t> &counts, int bits, size_t k = kSummaryTopStates)
+{
+    HistogramSummary summary;
+    summary.bits = bits;
+    summary.distinct = counts.size();
+    if (counts.empty())
+        return summary;
+    summary.least = {counts.begin()->first, counts.begin()->second};
+    for (const auto &[index, count] : counts)
+    {
+        summary.shots += count;
+        if (count < summary.least.count)
+            summary.least = {index, count};
+    }
+    summary.mean = double(summary.shots) / double(summary.distinct);
+    if (summary.distinct > 1)
+    {
+        double squares = 0.0;
+        for (const auto &entry : counts)
+            squares += (double(entry.second) - summary.mean) * (double(entry.second) - summary.mean);
+        summary.stddev = std::sqrt(squares / double(summary.distinct - 1));
+    }
+    summary.top = TopCounts(counts, k);
+    return summary;
+}
+
+/**
+ * @brief Summarise a histogram sampled from reg, including its distance to the exact distribution
+ */
+template <typename T>
+HistogramSummary Summarise(const BasicRegister<T> &reg, const std::map<uint64_t, size_t> &counts,
+                           size_t k = kSummaryTopStates)
+{
+    HistogramSummary summary = Summarise(counts, reg.bits, k);
+    if (summary.shots > 0)
+        summary.tvd = TotalVariationDistance(reg, counts);
+    return summary;
+}
+
+#endif // STATISTICS_CL_CPP
@@ -0,0 +1,624 @@
+/**
+ * @file Tests.cpp
+ * @brief Regression checks for behaviour that is easy to break and hard to see
+ *
+ * Each test is a function returning true on success; main() runs them all,
+ * prints one line per test and exits non-zero if any failed. The checks are
+ * deterministic and small enough for a debug build.
+ *
+ * The numerically subtle paths (fusion and cache blocking, sparse promotion,
+ * batched kernels, oracles, partial measurement) are compared against a
+ * naive reference simulator that applies each 2×2 operation index by index.
+ *
+ * Build & Run:
+ * g++ -std=c++17 -O2 -pthread Tests.cpp -o tests.exe && ./tests.exe
+ * (add -fsanitize=thread to check the thread pool under ThreadSanitizer)
+ *
+ * @author Your Name
+ * @date 2025
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Parallel_cl.cpp"
+#include "AsyncExecutor_cl.cpp"
+#include "Circuit_cl.cpp"
+#include "Oracle_cl.cpp"
+#include "RegisterBatch_cl.cpp"
+#include "RegisterGates_cl.cpp"
+#include "Snapshot_cl.cpp"
+#include "SparseRegister_cl.cpp"
+
+/**
+ * @brief An exception from a chunk reaches the caller, and the pool stays usable
+ *
+ * Throws once from the caller's first chunk and once from a chunk that a
+ * worker is likely to run, then checks that a following job covers its
+ * whole range.
+ */
+bool TestParallelForRethrows(){
+    ThreadPool &pool = ThreadPool::Instance();
+    pool.SetThreadCount(4);
+    for(uint64_t thrower : {uint64_t(0), uint64_t(63)}){
+        bool caught = false;
+        try{
+            pool.ParallelFor(64, 1, [thrower](uint64_t begin, uint64_t end){
+                for(uint64_t i = begin; i < end; ++i){
+                    if(i == thrower) throw std::runtime_error("chunk failed");
+                }
+            });
+        }catch(const std::runtime_error&){
+            caught = true;
+        }
+        if(!caught) return false;
+    }
+    std::atomic<uint64_t> sum{0};
+    pool.ParallelFor(1000, 10, [&sum](uint64_t begin, uint64_t end){
+        for(uint64_t i = begin; i < end; ++i) sum += i;
+    });
+    return sum == 999 * 1000 / 2;
+}
+
+/**
+ * @brief Workers started after earlier jobs wait for the next job instead of replaying the last
+ *
+ * One thread keeps resizing the pool while another runs jobs; every job must
+ * still visit each index exactly once.
+ */
+bool TestSetThreadCountBetweenJobs(){
+    ThreadPool &pool = ThreadPool::Instance();
+    pool.SetThreadCount(3);
+    std::atomic<bool> stop{false};
+    std::thread resizer([&]{
+        for(unsigned k = 0; !stop; ++k) pool.SetThreadCount(1 + k % 4);
+    });
+    bool ok = true;
+    for(int job = 0; job < 200 && ok; ++job){
+        std::vector<std::atomic<int>> visits(256);
+        pool.ParallelFor(visits.size(), 4, [&visits](uint64_t begin, uint64_t end){
+            for(uint64_t i = begin; i < end; ++i) ++visits[i];
+        });
+        for(const auto& v : visits) ok = ok && v == 1;
+    }
+    stop = true;
+    resizer.join();
+    pool.SetThreadCount(0);
+    return ok;
+}
+
+/**
+ * @brief Whether opening a snapshot with this header (and 64 data bytes) is refused
+ */
+static bool SnapshotRejected(const SnapshotHeader &header){
+    const std::string filename = "tests_crafted.qsnap";
+    const char data[64] = {};
+    const void *parts[] = {data};
+    if(!WriteSnapshotData(filename, header, parts, 1, sizeof(data))) return false;
+    bool rejected = false;
+    try{
+        MappedSnapshot snapshot(filename);
+    }catch(const std::runtime_error&){
+        rejected = true;
+    }
+    std::remove(filename.c_str());
+    return rejected;
+}
+
+/**
+ * @brief Crafted headers whose data size overflows, or whose layout Real() cannot serve, are rejected
+ *
+ * 2^n · 2 · scalarBytes wraps to 0 for n = 60..62 (double) and 61..62
+ * (float), which a multiplying size check would accept against any file.
+ */
+bool TestSnapshotRejectsCraftedHeaders(){
+    bool ok = true;
+    for(int n : {60, 61, 62})
+        ok = ok && SnapshotRejected(SnapshotHeader::Make(n, sizeof(double), SnapshotLayout::Interleaved));
+    for(int n : {61, 62})
+        ok = ok && SnapshotRejected(SnapshotHeader::Make(n, sizeof(float), SnapshotLayout::Interleaved));
+    ok = ok && SnapshotRejected(SnapshotHeader::Make(2, sizeof(float), SnapshotLayout::Split));
+    ok = ok && SnapshotRejected(SnapshotHeader::Make(3, sizeof(double), SnapshotLayout::Interleaved));    // 128 bytes declared
+    ok = ok && !SnapshotRejected(SnapshotHeader::Make(2, sizeof(double), SnapshotLayout::Interleaved));  // Exactly 64 bytes
+    ok = ok && !SnapshotRejected(SnapshotHeader::Make(2, sizeof(double), SnapshotLayout::Split));
+    return ok;
+}
+
+/**
+ * @brief ApplyIndexPermutation gives the same state on every path and thread count
+ *
+ * A random bijection on 2^16 indices (several pool chunks) is applied with
+ * 1, 2 and 4 threads through the out-of-place scatter and once with a budget
+ * that only fits the register, forcing the in-place cycle walk; every result
+ * must equal amp'[table[i]] = amp[i] exactly.
+ */
+bool TestIndexPermutationDeterministic(){
+    const int n = 16;
+    const uint64_t size = uint64_t(1) << n;
+    std::mt19937_64 rng(2025);
+    std::vector<uint64_t> table(size);
+    for(uint64_t i = 0; i < size; ++i) table[i] = i;
+    std::shuffle(table.begin(), table.end(), rng);
+    Register start(n);
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    for(auto& a : start.val) a = Register::Amplitude(uniform(rng), uniform(rng));
+    start.MarkDirty();
+    std::vector<Register::Amplitude> expected(size);
+    for(uint64_t i = 0; i < size; ++i) expected[table[i]] = start.val[i];
+
+    auto matches = [&](const Register& reg){
+        return std::equal(reg.val.begin(), reg.val.end(), expected.begin());
+    };
+    bool ok = true;
+    ThreadPool &pool = ThreadPool::Instance();
+    for(unsigned threads : {1u, 2u, 4u}){
+        pool.SetThreadCount(threads);
+        Register reg = start;
+        ApplyIndexPermutation(reg, table);
+        ok = ok && matches(reg);
+    }
+    const uint64_t budget = Register::MemoryBudget();
+    Register::SetMemoryBudget(Register::StateBytes(n, sizeof(Register::Amplitude)));
+    Register reg = start;
+    ApplyIndexPermutation(reg, table);
+    ok = ok && matches(reg);
+    Register::SetMemoryBudget(budget);
+    pool.SetThreadCount(0);
+    return ok;
+}
+
+/**
+ * @brief A StateVector built with a count is zeroed, even on a block recycled from the pool
+ *
+ * An H^n register is dropped so its block returns to the pool; a buffer of
+ * the same size must then read as zeros, and a register adopting it with
+ * one amplitude set must be exactly that basis state.
+ */
+bool TestStateVectorValueInitialised(){
+    const int n = 14;
+    {
+        Register scratch(n);
+        HadamardR().Apply(scratch);
+    }
+    Register::StateVector buf(std::size_t(1) << n);
+    bool ok = std::all_of(buf.begin(), buf.end(), [](const Register::Amplitude& a){ return a == Register::Amplitude(0, 0); });
+    buf[0] = 1;
+    Register reg(n, std::move(buf));
+    ok = ok && reg.GetProbab(0) == 1.0 && reg.GetProbab(5) == 0.0;
+    return ok;
+}
+
+/**
+ * @brief Register gate without a 2×2 matrix, standing in for user-defined kernels
+ */
+class NoMatrixGateR : public RGateKernels<NoMatrixGateR>{
+public:
+    template <typename T>
+    void Kernel(BasicRegister<T>&, int) const {}
+};
+
+/**
+ * @brief Circuits record controlled register gates as controlled operations and refuse matrix-less ones
+ *
+ * Holds with NDEBUG too: the refusal is an exception, not an assert.
+ */
+bool TestCircuitGateOverloads(){
+    Circuit bell(2);
+    bell.Gate(HadamardR(), 1).Gate(CNotGateR(1), 0);
+    Register reg(2);
+    bell.Compile().Execute(reg);
+    bool ok = std::abs(reg.GetProbab(0) - 0.5) < 1e-12 && std::abs(reg.GetProbab(3) - 0.5) < 1e-12;
+
+    const CNotGateR cnot(1);
+    const NoMatrixGateR custom;
+    for(const RGates* gate : {static_cast<const RGates*>(&cnot), static_cast<const RGates*>(&custom)}){
+        bool thrown = false;
+        try{
+            Circuit c(2);
+            c.Gate(*gate, 0);
+        }catch(const std::invalid_argument&){
+            thrown = true;
+        }
+        ok = ok && thrown;
+    }
+    return ok;
+}
+
+/**
+ * @brief Paths that apply gates through Matrix() refuse matrix-less gates with an exception
+ *
+ * A CNOT seen through RGates& (so the controlled overloads are not chosen)
+ * must not reach the fuser, a sparse register or a batch as an empty matrix.
+ */
+bool TestMatrixPathsRejectMatrixlessGates(){
+    const CNotGateR cnot(1);
+    const RGates& gate = cnot;
+    GateFuser fuser;
+    SparseRegister sparse(3);
+    BasicRegisterBatch<double> batch(3, 2);
+    auto throws = [](auto&& apply){
+        try{
+            apply();
+        }catch(const std::invalid_argument&){
+            return true;
+        }
+        return false;
+    };
+    return throws([&]{ fuser.Queue(gate, 0); }) && throws([&]{ sparse.ApplyGate(gate, 0); }) &&
+           throws([&]{ batch.ApplyGate(gate, 0); }) && fuser.QueuedGates() == 0;
+}
+
+/**
+ * @brief Random normalised state on n qubits (fixed seed)
+ */
+static Register RandomRegister(int n, uint64_t seed){
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<double> gauss;
+    std::vector<uint64_t> indices(uint64_t(1) << n);
+    std::vector<std::complex<double>> amplitudes(indices.size());
+    for(uint64_t i = 0; i < indices.size(); ++i){
+        indices[i] = i;
+        amplitudes[i] = {gauss(rng), gauss(rng)};
+    }
+    return Register(n, indices, amplitudes);
+}
+
+/**
+ * @brief Largest |a_i − b_i| over two equally sized states
+ */
+template <typename A, typename B>
+static double MaxDifference(const A& a, const B& b){
+    double worst = 0.0;
+    for(size_t i = 0; i < a.size(); ++i) worst = std::max(worst, double(std::abs(a[i] - b[i])));
+    return worst;
+}
+
+/**
+ * @brief Z, S and T match the generic 2×2 kernel on both sides of the static-kernel cutoff
+ */
+bool TestFixedPhasesMatchMatrix(){
+    const ZGateR z;
+    const SGateR s;
+    const TGateR t;
+    bool ok = true;
+    for(int n : {1, 3, kStaticGateMaxQubits, kStaticGateMaxQubits + 1}){
+        for(const RGates* gate : {static_cast<const RGates*>(&z), static_cast<const RGates*>(&s), static_cast<const RGates*>(&t)}){
+            for(int q = 0; q < n; ++q){
+                Register reg = RandomRegister(n, 7 + q), reference = reg;
+                gate->ApplyToSingle(reg, q);
+                ApplyMatrix2(reference.val.data(), reference.val.size(), q, *gate->Matrix());
+                ok = ok && MaxDifference(reg.val, reference.val) < 1e-14;
+            }
+        }
+    }
+    return ok;
+}
+
+/**
+ * @brief Concurrent Submit() calls never hold more than maxQueued waiting circuits
+ *
+ * Several threads submit to one simulator with maxQueued = 1, so at most one
+ * job runs and one waits: Pending() must never exceed 2 (no CSV exports).
+ */
+bool TestAsyncSubmitBound(){
+    Circuit circuit(10);
+    for(int layer = 0; layer < 4; ++layer){
+        for(int q = 0; q < 10; ++q) circuit.H(q).T(q);
+    }
+    const CompiledCircuit program = circuit.Compile();
+    AsyncExecutor executor(1, 1);
+    std::atomic<bool> done{false};
+    std::atomic<size_t> most{0};
+    std::thread monitor([&]{
+        while(!done){
+            size_t pending = executor.Pending();
+            if(pending > most) most = pending;
+        }
+    });
+    std::vector<std::thread> submitters;
+    for(int t = 0; t < 6; ++t){
+        submitters.emplace_back([&]{
+            for(int job = 0; job < 10; ++job) executor.Submit(program, Register(10), 16);
+        });
+    }
+    for(auto& t : submitters) t.join();
+    executor.Wait();
+    done = true;
+    monitor.join();
+    return most <= 2 && executor.Pending() == 0;
+}
+
+/**
+ * @brief Operation of the naive reference simulator: u on target where all control bits are set
+ */
+struct ReferenceOp{
+    int target;
+    uint64_t controls;
+    Matrix2 u;
+};
+using ReferenceState = std::vector<std::complex<double>>;
+
+/**
+ * @brief Apply one operation to a reference state by visiting every index, no kernels involved
+ */
+static void ApplyReference(ReferenceState& psi, const ReferenceOp& op){
+    const uint64_t mask = uint64_t(1) << op.target;
+    for(uint64_t i = 0; i < psi.size(); ++i){
+        if((i & mask) || (i & op.controls) != op.controls) continue;
+        const std::complex<double> a = psi[i], b = psi[i | mask];
+        psi[i] = op.u.m[0] * a + op.u.m[1] * b;
+        psi[i | mask] = op.u.m[2] * a + op.u.m[3] * b;
+    }
+}
+
+/**
+ * @brief Random 2×2 unitary from ZYZ Euler angles and a global phase
+ */
+static Matrix2 RandomUnitary(std::mt19937_64& rng){
+    std::uniform_real_distribution<double> angle(0.0, 4.0 * std::acos(0.0));   // [0, 2π)
+    const double alpha = angle(rng), beta = angle(rng), gamma = angle(rng), delta = angle(rng);
+    const double c = std::cos(gamma / 2), s = std::sin(gamma / 2);
+    const std::complex<double> g = std::polar(1.0, alpha);
+    return Matrix2{{g * std::polar(c, -(beta + delta) / 2), -g * std::polar(s, -(beta - delta) / 2),
+                    g * std::polar(s, (beta - delta) / 2), g * std::polar(c, (beta + delta) / 2)}};
+}
+
+/**
+ * @brief Record a random circuit of named, arbitrary and controlled gates, returning its reference ops
+ */
+static std::vector<ReferenceOp> RandomCircuit(Circuit& circuit, int n, int gates, uint64_t seed){
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<int> qubit(0, n - 1), kind(0, 10);
+    std::vector<ReferenceOp> ops;
+    for(int g = 0; g < gates; ++g){
+        const int t = qubit(rng);
+        int c1 = qubit(rng), c2 = qubit(rng);
+        while(c1 == t) c1 = qubit(rng);
+        while(c2 == t || c2 == c1) c2 = qubit(rng);
+        const uint64_t one = uint64_t(1) << c1, two = one | (uint64_t(1) << c2);
+        switch(kind(rng)){
+            case 0: circuit.H(t); ops.push_back({t, 0, *HadamardR().Matrix()}); break;
+            case 1: circuit.X(t); ops.push_back({t, 0, *XGateR().Matrix()}); break;
+            case 2: circuit.Y(t); ops.push_back({t, 0, *YGateR().Matrix()}); break;
+            case 3: circuit.Z(t); ops.push_back({t, 0, *ZGateR().Matrix()}); break;
+            case 4: circuit.S(t); ops.push_back({t, 0, *SGateR().Matrix()}); break;
+            case 5: circuit.T(t); ops.push_back({t, 0, *TGateR().Matrix()}); break;
+            case 6: case 7: {
+                const Matrix2 u = RandomUnitary(rng);
+                circuit.Gate(u, t);
+                ops.push_back({t, 0, u});
+                break;
+            }
+            case 8: circuit.CNOT(c1, t); ops.push_back({t, one, *XGateR().Matrix()}); break;
+            case 9: circuit.Toffoli(c1, c2, t); ops.push_back({t, two, *XGateR().Matrix()}); break;
+            default: {
+                const Matrix2 u = RandomUnitary(rng);
+                circuit.Controlled(u, t, {c1});
+                ops.push_back({t, one, u});
+                break;
+            }
+        }
+    }
+    return ops;
+}
+
+/**
+ * @brief Compiled circuits match the naive reference for every fusion width and with cache blocking
+ *
+ * Covers Compile(1..3) (same-qubit and 2/3-qubit block fusion, kernel
+ * selection) and Compile(2, localQubits) with blocks smaller than the
+ * register, so gates on high qubits go through the Swap remap and runs of
+ * local gates through Tile.
+ */
+bool TestCompiledCircuitsMatchReference(){
+    const int n = 10;
+    bool ok = true;
+    for(uint64_t seed = 1; seed <= 4; ++seed){
+        Circuit circuit(n);
+        const std::vector<ReferenceOp> ops = RandomCircuit(circuit, n, 120, seed);
+        const Register start = RandomRegister(n, 100 + seed);
+        ReferenceState expected(start.val.begin(), start.val.end());
+        for(const ReferenceOp& op : ops) ApplyReference(expected, op);
+
+        std::vector<CompiledCircuit> programs;
+        for(int maxBlock = 1; maxBlock <= 3; ++maxBlock) programs.push_back(circuit.Compile(maxBlock));
+        for(int local : {3, 4, 7}) programs.push_back(circuit.Compile(2, local));
+        programs.push_back(circuit.Compile(3, 5));
+        for(const CompiledCircuit& program : programs){
+            Register reg = start;
+            program.Execute(reg);
+            ok = ok && MaxDifference(reg.val, expected) < 1e-10;
+        }
+    }
+    return ok;
+}
+
+/**
+ * @brief A sparse register tracks the reference before, across and after promotion to dense
+ */
+bool TestSparsePromotionMatchesReference(){
+    const int n = 8;
+    SparseRegister sparse(n, 0.25);
+    ReferenceState expected(uint64_t(1) << n, 0.0);
+    expected[0] = 1.0;
+    std::mt19937_64 rng(11);
+    auto check = [&]{
+        double worst = 0.0;
+        for(uint64_t i = 0; i < expected.size(); ++i) worst = std::max(worst, std::abs(sparse.GetAmplitude(i) - expected[i]));
+        return worst < 1e-12;
+    };
+    bool ok = check() && !sparse.IsDense();
+    bool wasSparse = !sparse.IsDense(), promoted = false;
+    for(int step = 0; step < 3 * n; ++step){
+        const int t = step % n;
+        const Matrix2 u = step < n ? *HadamardR().Matrix() : RandomUnitary(rng);
+        if(step % 3 == 2){
+            const uint64_t control = uint64_t(1) << ((t + 3) % n);
+            sparse.ApplyControlled(t, control, u);
+            ApplyReference(expected, {t, control, u});
+        }else{
+            sparse.ApplyMatrix(t, u);
+            ApplyReference(expected, {t, 0, u});
+        }
+        promoted = promoted || (wasSparse && sparse.IsDense());
+        wasSparse = !sparse.IsDense();
+        ok = ok && check();
+    }
+    sparse.ApplySwap(1, 6);
+    for(uint64_t i = 0; i < expected.size(); ++i){
+        const uint64_t j = (i & ~uint64_t(0b1000010)) | (((i >> 1) & 1) << 6) | (((i >> 6) & 1) << 1);
+        if(i < j) std::swap(expected[i], expected[j]);
+    }
+    return ok && check() && promoted && std::abs(sparse.MagnitudeSquareSum() - 1.0) < 1e-12;
+}
+
+/**
+ * @brief Shared and per-state batch kernels match each member simulated on its own
+ */
+bool TestRegisterBatchMatchesReference(){
+    const int n = 6;
+    const uint64_t B = 5;
+    std::vector<Register> members;
+    for(uint64_t b = 0; b < B; ++b) members.push_back(RandomRegister(n, 200 + b));
+    BasicRegisterBatch<double> batch(members);
+    std::vector<ReferenceState> expected;
+    for(const Register& m : members) expected.emplace_back(m.val.begin(), m.val.end());
+
+    std::mt19937_64 rng(12);
+    for(int step = 0; step < 24; ++step){
+        const int t = step % n;
+        const uint64_t controls = step % 4 == 3 ? (uint64_t(1) << ((t + 2) % n)) | (uint64_t(1) << ((t + 5) % n)) : 0;
+        if(step % 2 == 0){
+            const Matrix2 u = RandomUnitary(rng);
+            batch.ApplyControlled(t, controls, u);
+            for(auto& e : expected) ApplyReference(e, {t, controls, u});
+        }else{
+            std::vector<Matrix2> perState(B);
+            for(auto& u : perState) u = RandomUnitary(rng);
+            batch.ApplyControlledEach(t, controls, perState);
+            for(uint64_t b = 0; b < B; ++b) ApplyReference(expected[b], {t, controls, perState[b]});
+        }
+    }
+    batch.ApplyGate(HadamardR(), 2);
+    batch.ApplyGate(CNotGateR(4), 0);
+    for(auto& e : expected){
+        ApplyReference(e, {2, 0, *HadamardR().Matrix()});
+        ApplyReference(e, {0, uint64_t(1) << 4, *XGateR().Matrix()});
+    }
+
+    bool ok = true;
+    const std::vector<double> norms = batch.MagnitudeSquareSums(), ones = batch.ProbabilityOne(3);
+    for(uint64_t b = 0; b < B; ++b){
+        ok = ok && MaxDifference(batch.GetState(b).val, expected[b]) < 1e-12;
+        double one = 0.0;
+        for(uint64_t i = 0; i < expected[b].size(); ++i) one += (i >> 3) & 1 ? std::norm(expected[b][i]) : 0.0;
+        ok = ok && std::abs(norms[b] - 1.0) < 1e-12 && std::abs(ones[b] - one) < 1e-12;
+    }
+    return ok;
+}
+
+/**
+ * @brief Phase and bit oracles match (-1)^f(x) and |x⟩|y ⊕ f(x)⟩, with spectator qubits above
+ */
+bool TestBooleanOracleMatchesReference(){
+    const int n = 7;
+    std::mt19937_64 rng(13);
+    std::vector<bool> truth(uint64_t(1) << n);
+    for(uint64_t x = 0; x < truth.size(); ++x) truth[x] = rng() & 1;
+    const BooleanOracle table = BooleanOracle::FromTruthTable(n, truth);
+    const BooleanOracle linear = BooleanOracle::Linear(n, 0b1011001, true);
+    bool ok = true;
+    for(const BooleanOracle* oracle : {&table, &linear}){
+        for(uint64_t x = 0; x < truth.size(); ++x){
+            const bool f = oracle == &table ? bool(truth[x]) : ((std::bitset<64>(x & 0b1011001).count() & 1) != 0) != true;
+            ok = ok && oracle->Evaluate(x) == f;
+        }
+
+        Register phase = RandomRegister(n + 2, 300);           // Two spectators
+        ReferenceState expected(phase.val.begin(), phase.val.end());
+        oracle->ApplyPhase(phase);
+        for(uint64_t i = 0; i < expected.size(); ++i){
+            if(oracle->Evaluate(i & ((uint64_t(1) << n) - 1))) expected[i] = -expected[i];
+        }
+        ok = ok && MaxDifference(phase.val, expected) < 1e-15;
+
+        Register bit = RandomRegister(n + 2, 301);             // Ancilla on qubit 0, one spectator
+        expected.assign(bit.val.begin(), bit.val.end());
+        oracle->ApplyBit(bit);
+        for(uint64_t i = 0; i < expected.size(); i += 2){
+            if(oracle->Evaluate((i >> 1) & ((uint64_t(1) << n) - 1))) std::swap(expected[i], expected[i + 1]);
+        }
+        ok = ok && MaxDifference(bit.val, expected) < 1e-15;
+    }
+    return ok;
+}
+
+/**
+ * @brief Measure(mask) projects onto the drawn outcome, renormalises, and draws by the marginals
+ */
+bool TestMaskedMeasurementMatchesReference(){
+    const int n = 8;
+    const uint64_t mask = 0b10100101;
+    const Register start = RandomRegister(n, 400);
+    std::map<uint64_t, double> marginal;
+    for(uint64_t i = 0; i < start.val.size(); ++i) marginal[i & mask] += std::norm(start.val[i]);
+
+    bool ok = true;
+    std::map<uint64_t, size_t> counts;
+    const size_t trials = 4000;
+    for(size_t trial = 0; trial < trials; ++trial){
+        Register reg = start;
+        reg.Seed(trial);
+        const uint64_t m = reg.Measure(mask);
+        ++counts[m];
+        if(trial < 20){                                     // Full projection check on a few draws
+            ok = ok && (m & ~mask) == 0 && marginal[m] > 0.0;
+            double worst = 0.0;
+            for(uint64_t i = 0; i < start.val.size(); ++i){
+                const std::complex<double> a = (i & mask) == m ? start.val[i] / std::sqrt(marginal[m]) : 0.0;
+                worst = std::max(worst, std::abs(reg.val[i] - a));
+            }
+            ok = ok && worst < 1e-12 && std::abs(reg.MagnitudeSquareSum() - 1.0) < 1e-12;
+        }
+    }
+    double tvd = 0.0;
+    for(const auto& [outcome, p] : marginal) tvd += std::abs(p - double(counts[outcome]) / trials);
+    return ok && 0.5 * tvd < 0.05;
+}
+
+int main(){
+    struct Test{ const char* name; bool (*run)(); };
+    const Test tests[] = {
+        {"ParallelFor rethrows chunk exceptions", TestParallelForRethrows},
+        {"SetThreadCount between jobs", TestSetThreadCountBetweenJobs},
+        {"Snapshot rejects crafted headers", TestSnapshotRejectsCraftedHeaders},
+        {"Index permutation is deterministic", TestIndexPermutationDeterministic},
+        {"StateVector is value-initialised", TestStateVectorValueInitialised},
+        {"Circuit gate overloads", TestCircuitGateOverloads},
+        {"Matrix paths reject matrix-less gates", TestMatrixPathsRejectMatrixlessGates},
+        {"Z, S, T match the 2x2 kernel", TestFixedPhasesMatchMatrix},
+        {"Concurrent Submit keeps the queue bound", TestAsyncSubmitBound},
+        {"Compiled circuits match the reference", TestCompiledCircuitsMatchReference},
+        {"Sparse promotion matches the reference", TestSparsePromotionMatchesReference},
+        {"Register batch matches the reference", TestRegisterBatchMatchesReference},
+        {"Boolean oracles match the reference", TestBooleanOracleMatchesReference},
+        {"Measure(mask) matches the reference", TestMaskedMeasurementMatchesReference},
+    };
+    int failures = 0;
+    for(const Test& t : tests){
+        const bool ok = t.run();
+        std::printf("%-50s %s\n", t.name, ok ? "ok" : "FAILED");
+        failures += ok ? 0 : 1;
+    }
+    return failures == 0 ? 0 : 1;
+}